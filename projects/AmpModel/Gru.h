@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <cmath>
 
+#include "FastMath.h"
 #include "GruParameters.h"
 
 
@@ -37,7 +38,7 @@ public:
     float sigmoid(float x) const
     {
         // TODO 1) Implement the sigmoid function
-        return 1.0f / (1.0f + std::exp(-x));
+        return 1.0f / (1.0f + (fast_math ? DSP::FastMath::exp(-x) : std::exp(-x)));
     }
 
     void process(float * const * output, const float * const * input, size_t num_samples)
@@ -116,7 +117,7 @@ public:
                 n_gate[i] += n_hidden[i];
                 // TODO 3.5) Apply tanh activation function to n_gate
                 // nt_i = tanh(...)
-                n_gate[i] = std::tanh(n_gate[i]);
+                n_gate[i] = fast_math ? DSP::FastMath::tanh(n_gate[i]) : std::tanh(n_gate[i]);
             }
 
             // TODO 4) Compute the new state h_t = (1 - z) * n + z * h_{t-1}
@@ -169,6 +170,12 @@ public:
         memset(state, 0, sizeof(state));
     }
 
+    // Run the sigmoid and tanh activations on the DSP::FastMath approximations
+    void set_fast_math(bool use_fast_math)
+    {
+        fast_math = use_fast_math;
+    }
+
 private:
     // model parameters
     float weight_ih_r[HIDDEN_SIZE][INPUT_SIZE];
@@ -192,4 +199,6 @@ private:
 
     // gru state
     float state[HIDDEN_SIZE];
+
+    bool fast_math = false;
 };
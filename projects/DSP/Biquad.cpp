@@ -1,6 +1,7 @@
 #include "Biquad.h"
 
 #include <algorithm>
+#include <cmath>
 
 namespace DSP
 {
@@ -9,8 +10,10 @@ Biquad::Biquad(unsigned int maxNumSections, unsigned int maxNumChannels) :
     allocatedChannels { maxNumChannels },
     allocatedSections { maxNumSections },
     coeffs(allocatedSections * CoeffsPerSection, 0.f),
-    states(allocatedChannels * allocatedSections * StatesPerSection, 0.f)
+    stateSpaceCoeffs(allocatedSections * StateSpaceCoeffsPerSection, 0.f)
 {
+    resizeStates();
+    resizeCoeffRamps();
 }
 
 Biquad::Biquad()
@@ -29,7 +32,7 @@ void Biquad::clear()
 void Biquad::reallocateChannels(unsigned int maxNumChannels)
 {
     allocatedChannels = maxNumChannels;
-    states.resize(allocatedChannels * allocatedSections * StatesPerSection);
+    resizeStates();
     std::fill(states.begin(), states.end(), 0.f);
 }
 
@@ -37,72 +40,388 @@ void Biquad::reallocateSections(unsigned int numSections)
 {
     allocatedSections = numSections;
     coeffs.resize(allocatedSections * CoeffsPerSection);
-    states.resize(allocatedChannels * allocatedSections * StatesPerSection);
+    stateSpaceCoeffs.resize(allocatedSections * StateSpaceCoeffsPerSection);
+    resizeStates();
+    resizeCoeffRamps();
     std::fill(coeffs.begin(), coeffs.end(), 0.f);
+    std::fill(stateSpaceCoeffs.begin(), stateSpaceCoeffs.end(), 0.f);
     std::fill(states.begin(), states.end(), 0.f);
 }
 
-void Biquad::setSectionCoeffs(const std::array<float, CoeffsPerSection>& newSectionCoeffs, unsigned int section)
+void Biquad::setSectionCoeffs(const std::array<float, CoeffsPerSection>& newSectionCoeffs, unsigned int section, unsigned int numRampSamples)
 {
-    if (section < allocatedSections)
+    if (section >= allocatedSections)
+        return;
+
+    if (numRampSamples == 0)
+    {
+        std::copy(newSectionCoeffs.begin(), newSectionCoeffs.end(), coeffs.begin() + (section * CoeffsPerSection));
+        if (topology == StateSpace)
+            updateStateSpaceCoeffs(section);
+
+        if (rampSamplesLeft[section] > 0)
+        {
+            rampSamplesLeft[section] = 0;
+            --numRampingSections;
+        }
+
+        return;
+    }
+
+    // Ramp the coefficients the current topology runs on
+    float* target { rampTargets.data() + section * MaxCoeffsPerSection };
+    const float* current { nullptr };
+    unsigned int numCoeffs { 0 };
+    if (topology == StateSpace)
+    {
         std::copy(newSectionCoeffs.begin(), newSectionCoeffs.end(), coeffs.begin() + (section * CoeffsPerSection));
+        calculateStateSpaceCoeffs(newSectionCoeffs.data(), target);
+        current = stateSpaceCoeffs.data() + section * StateSpaceCoeffsPerSection;
+        numCoeffs = StateSpaceCoeffsPerSection;
+    }
+    else
+    {
+        std::copy(newSectionCoeffs.begin(), newSectionCoeffs.end(), target);
+        current = coeffs.data() + section * CoeffsPerSection;
+        numCoeffs = CoeffsPerSection;
+    }
+
+    float* delta { rampDeltas.data() + section * MaxCoeffsPerSection };
+    const float invRampSamples { 1.f / static_cast<float>(numRampSamples) };
+    for (unsigned int i = 0; i < numCoeffs; ++i)
+        delta[i] = (target[i] - current[i]) * invRampSamples;
+
+    if (rampSamplesLeft[section] == 0)
+        ++numRampingSections;
+
+    rampSamplesLeft[section] = numRampSamples;
+}
+
+void Biquad::setTopology(Topology newTopology)
+{
+    // Land running ramps on their targets before the coefficient set changes
+    while (numRampingSections > 0)
+        advanceCoeffRamps();
+
+    topology = newTopology;
+    if (topology == StateSpace)
+        for (unsigned int s = 0; s < allocatedSections; ++s)
+            updateStateSpaceCoeffs(s);
+
+    statesPerSection = getStatesPerSection(topology);
+    resizeStates();
+    clear();
 }
 
 void Biquad::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
 {
     numChannels = std::min(numChannels, allocatedChannels);
-    for (unsigned int c = 0; c < numChannels; ++c)
+
+    // Coefficient ramps advance once per sample, so go frame by frame while ramping
+    unsigned int n { 0 };
+    for (; n < numSamples && numRampingSections > 0; ++n)
+    {
+        processFrame(output, input, numChannels, n);
+        advanceCoeffRamps();
+    }
+
+    for (unsigned int c0 = 0; c0 < numChannels && n < numSamples; c0 += Simd::Lanes)
     {
-        for (unsigned int n = 0; n < numSamples; ++n)
+        const unsigned int numLanes { std::min(numChannels - c0, Simd::Lanes) };
+        if (numLanes == 1u)
+        {
+            // a lone channel gains nothing from the vector path
+            for (unsigned int i = n; i < numSamples; ++i)
+                output[c0][i] = processSections(input[c0][i], c0);
+
+            continue;
+        }
+
+        const unsigned int endIdleChannel { std::min(c0 + Simd::Lanes, allocatedChannels) };
+        saveIdleStates(c0 + numLanes, endIdleChannel);
+
+        for (unsigned int i = n; i < numSamples; ++i)
         {
-            float x { input[c][n] };
-            for (unsigned int s = 0; s < allocatedSections; ++s)
-            {
-                const unsigned int stateOffset { c * allocatedSections * StatesPerSection + s * StatesPerSection };
-                const unsigned int coeffOffset { s * CoeffsPerSection };
-
-                float acc { x * coeffs[coeffOffset + 0] }; // b0
-                acc += coeffs[coeffOffset + 1] * states[stateOffset + 0]; // b1
-                acc += coeffs[coeffOffset + 2] * states[stateOffset + 1]; // b2
-                acc -= coeffs[coeffOffset + 3] * states[stateOffset + 2]; // a1
-                acc -= coeffs[coeffOffset + 4] * states[stateOffset + 3]; // a2
-
-                states[stateOffset + 1] = states[stateOffset + 0];
-                states[stateOffset + 0] = x;
-                states[stateOffset + 3] = states[stateOffset + 2];
-                states[stateOffset + 2] = acc;
-                x = acc;
-            }
-            output[c][n] = x;
+            float frame[Simd::Lanes] { 0.f, 0.f, 0.f, 0.f };
+            for (unsigned int l = 0; l < numLanes; ++l)
+                frame[l] = input[c0 + l][i];
+
+            processSections(Simd::Float4::load(frame), c0).store(frame);
+
+            for (unsigned int l = 0; l < numLanes; ++l)
+                output[c0 + l][i] = frame[l];
         }
+
+        restoreIdleStates(c0 + numLanes, endIdleChannel);
     }
 }
 
 void Biquad::process(float* output, const float* input, unsigned int numChannels)
 {
     numChannels = std::min(numChannels, allocatedChannels);
-    for (unsigned int c = 0; c < numChannels; ++c)
+    for (unsigned int c0 = 0; c0 < numChannels; c0 += Simd::Lanes)
     {
-        float x { input[c] };
-        for (unsigned int s = 0; s < allocatedSections; ++s)
+        const unsigned int numLanes { std::min(numChannels - c0, Simd::Lanes) };
+        if (numLanes == 1u)
+        {
+            output[c0] = processSections(input[c0], c0);
+            continue;
+        }
+
+        const unsigned int endIdleChannel { std::min(c0 + Simd::Lanes, allocatedChannels) };
+        saveIdleStates(c0 + numLanes, endIdleChannel);
+
+        float frame[Simd::Lanes] { 0.f, 0.f, 0.f, 0.f };
+        for (unsigned int l = 0; l < numLanes; ++l)
+            frame[l] = input[c0 + l];
+
+        processSections(Simd::Float4::load(frame), c0).store(frame);
+
+        for (unsigned int l = 0; l < numLanes; ++l)
+            output[c0 + l] = frame[l];
+
+        restoreIdleStates(c0 + numLanes, endIdleChannel);
+    }
+
+    if (numRampingSections > 0)
+        advanceCoeffRamps();
+}
+
+void Biquad::processFrame(float* const* output, const float* const* input, unsigned int numChannels, unsigned int n)
+{
+    for (unsigned int c0 = 0; c0 < numChannels; c0 += Simd::Lanes)
+    {
+        const unsigned int numLanes { std::min(numChannels - c0, Simd::Lanes) };
+        if (numLanes == 1u)
+        {
+            output[c0][n] = processSections(input[c0][n], c0);
+            continue;
+        }
+
+        const unsigned int endIdleChannel { std::min(c0 + Simd::Lanes, allocatedChannels) };
+        saveIdleStates(c0 + numLanes, endIdleChannel);
+
+        float frame[Simd::Lanes] { 0.f, 0.f, 0.f, 0.f };
+        for (unsigned int l = 0; l < numLanes; ++l)
+            frame[l] = input[c0 + l][n];
+
+        processSections(Simd::Float4::load(frame), c0).store(frame);
+
+        for (unsigned int l = 0; l < numLanes; ++l)
+            output[c0 + l][n] = frame[l];
+
+        restoreIdleStates(c0 + numLanes, endIdleChannel);
+    }
+}
+
+void Biquad::advanceCoeffRamps()
+{
+    const bool isStateSpace { topology == StateSpace };
+    const unsigned int numCoeffs { isStateSpace ? StateSpaceCoeffsPerSection : CoeffsPerSection };
+    float* sectionCoeffs { isStateSpace ? stateSpaceCoeffs.data() : coeffs.data() };
+
+    for (unsigned int s = 0; s < allocatedSections; ++s, sectionCoeffs += numCoeffs)
+    {
+        if (rampSamplesLeft[s] == 0)
+            continue;
+
+        if (--rampSamplesLeft[s] == 0)
+        {
+            // land exactly on the target
+            const float* target { rampTargets.data() + s * MaxCoeffsPerSection };
+            std::copy(target, target + numCoeffs, sectionCoeffs);
+            --numRampingSections;
+        }
+        else
         {
-            const unsigned int stateOffset { c * allocatedSections * StatesPerSection + s * StatesPerSection };
-            const unsigned int coeffOffset { s * CoeffsPerSection };
-
-            float acc { x * coeffs[coeffOffset + 0] }; // b0
-            acc += coeffs[coeffOffset + 1] * states[stateOffset + 0]; // b1
-            acc += coeffs[coeffOffset + 2] * states[stateOffset + 1]; // b2
-            acc -= coeffs[coeffOffset + 3] * states[stateOffset + 2]; // a1
-            acc -= coeffs[coeffOffset + 4] * states[stateOffset + 3]; // a2
-
-            states[stateOffset + 1] = states[stateOffset + 0];
-            states[stateOffset + 0] = x;
-            states[stateOffset + 3] = states[stateOffset + 2];
-            states[stateOffset + 2] = acc;
-            x = acc;
+            const float* delta { rampDeltas.data() + s * MaxCoeffsPerSection };
+            for (unsigned int i = 0; i < numCoeffs; ++i)
+                sectionCoeffs[i] += delta[i];
         }
-        output[c] = x;
     }
 }
 
+void Biquad::resizeStates()
+{
+    paddedChannels = (allocatedChannels + Simd::Lanes - 1u) / Simd::Lanes * Simd::Lanes;
+    states.reserve(paddedChannels * allocatedSections * StatesPerSection);
+    idleStates.reserve(Simd::Lanes * allocatedSections * StatesPerSection);
+    states.resize(paddedChannels * allocatedSections * statesPerSection);
+    idleStates.resize(Simd::Lanes * allocatedSections * statesPerSection);
+}
+
+void Biquad::resizeCoeffRamps()
+{
+    rampTargets.resize(allocatedSections * MaxCoeffsPerSection);
+    rampDeltas.resize(allocatedSections * MaxCoeffsPerSection);
+    rampSamplesLeft.resize(allocatedSections);
+    std::fill(rampSamplesLeft.begin(), rampSamplesLeft.end(), 0u);
+    numRampingSections = 0;
+}
+
+void Biquad::updateStateSpaceCoeffs(unsigned int section)
+{
+    calculateStateSpaceCoeffs(coeffs.data() + section * CoeffsPerSection,
+                              stateSpaceCoeffs.data() + section * StateSpaceCoeffsPerSection);
+}
+
+void Biquad::calculateStateSpaceCoeffs(const float* c, float* ss)
+{
+    // Map the biquad onto a trapezoidal SVF with outputs mixed as m0 * hp + m1 * bp + m2 * lp
+    // Denominator (1 + g k + g^2) + 2 (g^2 - 1) z^-1 + (1 - g k + g^2) z^-2 gives g and k,
+    // numerator m0 (1 - z^-1)^2 + m1 g (1 - z^-2) + m2 g^2 (1 + z^-1)^2 gives the mix
+    const double b0 { c[0] }, b1 { c[1] }, b2 { c[2] }, a1 { c[3] }, a2 { c[4] };
+
+    const double d { 4.0 / std::fmax(1.0 - a1 + a2, 1e-12) };
+    const double gSquared { std::fmax((1.0 + a1 + a2) * d * 0.25, 1e-12) };
+    const double g { std::sqrt(gSquared) };
+    const double k { d * (1.0 - a2) * 0.5 / g };
+
+    const double m0 { d * (b0 - b1 + b2) * 0.25 };
+    const double m1 { d * (b0 - b2) * 0.5 / g };
+    const double m2 { d * (b0 + b1 + b2) * 0.25 / gSquared };
+
+    const double ss1 { 1.0 / (1.0 + g * (g + k)) };
+    const double ss2 { g * ss1 };
+    const double ss3 { g * ss2 };
+
+    // hp = x - k bp - lp, so fold the hp mix into the other taps
+    ss[0] = static_cast<float>(ss1);
+    ss[1] = static_cast<float>(ss2);
+    ss[2] = static_cast<float>(ss3);
+    ss[3] = static_cast<float>(m0);
+    ss[4] = static_cast<float>(m1 - k * m0);
+    ss[5] = static_cast<float>(m2 - m0);
+}
+
+template<typename T>
+T Biquad::processSections(T x, unsigned int channelOffset)
+{
+    switch (topology)
+    {
+    case TransposedDirectFormII:
+        return processSectionsTransposedDirectFormII(x, channelOffset);
+
+    case StateSpace:
+        return processSectionsStateSpace(x, channelOffset);
+
+    case DirectFormI:
+    default:
+        return processSectionsDirectFormI(x, channelOffset);
+    }
+}
+
+template<typename T>
+T Biquad::processSectionsDirectFormI(T x, unsigned int channelOffset)
+{
+    float* sectionStates { states.data() + channelOffset };
+    const float* sectionCoeffs { coeffs.data() };
+
+    for (unsigned int s = 0; s < allocatedSections; ++s)
+    {
+        float* bz1 { sectionStates };
+        float* bz2 { bz1 + paddedChannels };
+        float* az1 { bz2 + paddedChannels };
+        float* az2 { az1 + paddedChannels };
+
+        const T xz1 { Simd::load<T>(bz1) };
+        const T yz1 { Simd::load<T>(az1) };
+
+        T acc { x * Simd::broadcast<T>(sectionCoeffs[0]) }; // b0
+        acc = acc + Simd::broadcast<T>(sectionCoeffs[1]) * xz1; // b1
+        acc = acc + Simd::broadcast<T>(sectionCoeffs[2]) * Simd::load<T>(bz2); // b2
+        acc = acc - Simd::broadcast<T>(sectionCoeffs[3]) * yz1; // a1
+        acc = acc - Simd::broadcast<T>(sectionCoeffs[4]) * Simd::load<T>(az2); // a2
+
+        Simd::store(bz2, xz1);
+        Simd::store(bz1, x);
+        Simd::store(az2, yz1);
+        Simd::store(az1, acc);
+        x = acc;
+
+        sectionStates += statesPerSection * paddedChannels;
+        sectionCoeffs += CoeffsPerSection;
+    }
+
+    return x;
+}
+
+template<typename T>
+T Biquad::processSectionsTransposedDirectFormII(T x, unsigned int channelOffset)
+{
+    float* sectionStates { states.data() + channelOffset };
+    const float* sectionCoeffs { coeffs.data() };
+
+    for (unsigned int s = 0; s < allocatedSections; ++s)
+    {
+        float* z1 { sectionStates };
+        float* z2 { z1 + paddedChannels };
+
+        const T y { x * Simd::broadcast<T>(sectionCoeffs[0]) + Simd::load<T>(z1) };
+
+        // z1 = b1 x - a1 y + z2
+        T acc { x * Simd::broadcast<T>(sectionCoeffs[1]) };
+        acc = acc - y * Simd::broadcast<T>(sectionCoeffs[3]);
+        Simd::store(z1, acc + Simd::load<T>(z2));
+
+        // z2 = b2 x - a2 y
+        acc = x * Simd::broadcast<T>(sectionCoeffs[2]);
+        Simd::store(z2, acc - y * Simd::broadcast<T>(sectionCoeffs[4]));
+
+        x = y;
+
+        sectionStates += statesPerSection * paddedChannels;
+        sectionCoeffs += CoeffsPerSection;
+    }
+
+    return x;
+}
+
+template<typename T>
+T Biquad::processSectionsStateSpace(T x, unsigned int channelOffset)
+{
+    float* sectionStates { states.data() + channelOffset };
+    const float* sectionCoeffs { stateSpaceCoeffs.data() };
+
+    for (unsigned int s = 0; s < allocatedSections; ++s)
+    {
+        float* ic1eq { sectionStates };
+        float* ic2eq { ic1eq + paddedChannels };
+
+        const T s1 { Simd::load<T>(ic1eq) };
+        const T s2 { Simd::load<T>(ic2eq) };
+
+        // bp and lp outputs of the SVF
+        const T v3 { x - s2 };
+        const T v1 { Simd::broadcast<T>(sectionCoeffs[0]) * s1 + Simd::broadcast<T>(sectionCoeffs[1]) * v3 };
+        const T v2 { s2 + Simd::broadcast<T>(sectionCoeffs[1]) * s1 + Simd::broadcast<T>(sectionCoeffs[2]) * v3 };
+
+        Simd::store(ic1eq, v1 + v1 - s1);
+        Simd::store(ic2eq, v2 + v2 - s2);
+
+        T y { Simd::broadcast<T>(sectionCoeffs[3]) * x };
+        y = y + Simd::broadcast<T>(sectionCoeffs[4]) * v1;
+        x = y + Simd::broadcast<T>(sectionCoeffs[5]) * v2;
+
+        sectionStates += statesPerSection * paddedChannels;
+        sectionCoeffs += StateSpaceCoeffsPerSection;
+    }
+
+    return x;
+}
+
+void Biquad::saveIdleStates(unsigned int firstIdleChannel, unsigned int endIdleChannel)
+{
+    for (unsigned int i = 0; i < allocatedSections * statesPerSection; ++i)
+        for (unsigned int c = firstIdleChannel; c < endIdleChannel; ++c)
+            idleStates[i * Simd::Lanes + c % Simd::Lanes] = states[i * paddedChannels + c];
+}
+
+void Biquad::restoreIdleStates(unsigned int firstIdleChannel, unsigned int endIdleChannel)
+{
+    for (unsigned int i = 0; i < allocatedSections * statesPerSection; ++i)
+        for (unsigned int c = firstIdleChannel; c < endIdleChannel; ++c)
+            states[i * paddedChannels + c] = idleStates[i * Simd::Lanes + c % Simd::Lanes];
+}
+
 }
\ No newline at end of file
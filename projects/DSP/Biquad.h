@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Simd.h"
+
 #include <array>
 #include <vector>
 
@@ -20,8 +22,24 @@ public:
     const Biquad& operator=(Biquad&&) = delete;
 
     static const unsigned int CoeffsPerSection = 5;
+    // Most states a section can take, the DirectFormI count
     static const unsigned int StatesPerSection = 4;
 
+    // Filter structure used to realize the sections
+    // All topologies take the same b0, b1, b2, a1, a2 coefficients
+    //  - DirectFormI: 4 states, 5 mul, reference structure
+    //  - TransposedDirectFormII: 2 states, 5 mul, cheapest,
+    //    3-4 dB more noise than DirectFormI for low cutoffs
+    //  - StateSpace: 2 states, 7 mul, trapezoidal SVF equivalent,
+    //    35-43 dB less noise than DirectFormI for low cutoffs
+    // Noise as measured by snipets/biquad_topologies.cpp
+    enum Topology : unsigned int
+    {
+        DirectFormI = 0,
+        TransposedDirectFormII,
+        StateSpace
+    };
+
     // Clear all states
     void clear();
 
@@ -34,10 +52,19 @@ public:
     void reallocateSections(unsigned int numSections);
 
     // Set new coeffs to a section
-    void setSectionCoeffs(const std::array<float, CoeffsPerSection>& newSectionCoeffs, unsigned int section);
+    // With numRampSamples above 0 the coefficients in use are linearly interpolated
+    // towards the new ones over that many processed samples, the StateSpace topology
+    // interpolates its derived coefficients instead
+    void setSectionCoeffs(const std::array<float, CoeffsPerSection>& newSectionCoeffs, unsigned int section,
+                          unsigned int numRampSamples = 0);
+
+    // Select the filter structure
+    // Calling this method will clear the states
+    void setTopology(Topology newTopology);
 
     // Process audio
     // This method can be called with a lower number of channels than allocated
+    // Channels are processed side by side in groups of Simd::Lanes
     void process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples);
 
     // Process audio
@@ -50,18 +77,84 @@ public:
     // return the number of currently allocated sections
     unsigned int getAllocatedSections() const noexcept { return allocatedSections; }
 
+    // return the current filter structure
+    Topology getTopology() const noexcept { return topology; }
+
+    // return the number of states per section and channel of a filter structure
+    static unsigned int getStatesPerSection(Topology sectionTopology) noexcept { return sectionTopology == DirectFormI ? 4 : 2; }
+
 private:
     unsigned int allocatedChannels { 0 };
     unsigned int allocatedSections { 0 };
 
+    Topology topology { DirectFormI };
+    unsigned int statesPerSection { StatesPerSection };
+
+    // allocated channels rounded up to a multiple of Simd::Lanes
+    unsigned int paddedChannels { 0 };
+
     // vector of coeffs of all sections
     // [sos0_b0, sos0_b1, sos0_b2, sos0_a1, sos0_a2, sos1_b0, sos1_b1, ...]
     std::vector<float> coeffs;
 
-    // vector of states of all channels and sections
-    // [ch0_sos0_bz1, ... , ch0_sos0_az2, ch0_sos1_bz1, ... , ch0_sos1_az2, ... ,
-    //  ch1_sos0_bz1, ... , ch1_sos0_az2, ch1_sos1_bz1, ... , ch1_sos1_az2, ...]
+    // Number of derived coeffs per section of the state space form
+    static const unsigned int StateSpaceCoeffsPerSection = 6;
+
+    // vector of derived state space coeffs of all sections
+    // [sos0_a1, sos0_a2, sos0_a3, sos0_m0, sos0_m1, sos0_m2, sos1_a1, ...]
+    std::vector<float> stateSpaceCoeffs;
+
+    // vector of states of all channels and sections, channel interleaved
+    // so that a group of Simd::Lanes channels can be loaded as one register
+    // [sos0_bz1_ch0, sos0_bz1_ch1, ... , sos0_bz2_ch0, ... , sos0_az2_chN, sos1_bz1_ch0, ...]
+    // Sections are statesPerSection rows apart, so the 2 state topologies keep theirs packed
     std::vector<float> states;
+
+    // Per section coefficient ramps over the coefficients of the current topology
+    static const unsigned int MaxCoeffsPerSection = 6;
+    std::vector<float> rampTargets;
+    std::vector<float> rampDeltas;
+    std::vector<unsigned int> rampSamplesLeft;
+    unsigned int numRampingSections { 0 };
+
+    // scratch copy of the states of allocated channels that share a register
+    // with the processed ones but are not processed in the current call
+    std::vector<float> idleStates;
+
+    // Resize state storage to the current number of sections, channels and topology
+    // Capacity is kept for StatesPerSection, so a topology change does not allocate
+    void resizeStates();
+
+    // Resize ramp storage to the current number of sections and stop all ramps
+    void resizeCoeffRamps();
+
+    // Move all ramping sections one sample towards their target coeffs
+    void advanceCoeffRamps();
+
+    // Process one sample frame of a buffer for all channels
+    void processFrame(float* const* output, const float* const* input, unsigned int numChannels, unsigned int n);
+
+    // Derive the state space coeffs of a section from its biquad coeffs
+    void updateStateSpaceCoeffs(unsigned int section);
+    static void calculateStateSpaceCoeffs(const float* biquadCoeffs, float* stateSpaceCoeffs);
+
+    // Run one sample thru all sections, T is float for a single channel
+    // or Simd::Float4 for a group of Simd::Lanes channels
+    template<typename T>
+    T processSections(T x, unsigned int channelOffset);
+
+    template<typename T>
+    T processSectionsDirectFormI(T x, unsigned int channelOffset);
+
+    template<typename T>
+    T processSectionsTransposedDirectFormII(T x, unsigned int channelOffset);
+
+    template<typename T>
+    T processSectionsStateSpace(T x, unsigned int channelOffset);
+
+    // Save and restore the states of idle lanes in a channel group
+    void saveIdleStates(unsigned int firstIdleChannel, unsigned int endIdleChannel);
+    void restoreIdleStates(unsigned int firstIdleChannel, unsigned int endIdleChannel);
 };
 
 }
\ No newline at end of file
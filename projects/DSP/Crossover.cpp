@@ -0,0 +1,216 @@
+#include "Crossover.h"
+#include "ParametricEqualizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DSP
+{
+
+Crossover::Crossover(unsigned int numOfBands, unsigned int maxNumChannels) :
+    numBands { std::min(std::max(numOfBands, 2u), MaxBands) },
+    allocatedChannels { maxNumChannels },
+    frequencies(numBands - 1u, 1000.f)
+{
+    for (unsigned int c = 0; c < frequencies.size(); ++c)
+        frequencies[c] = 1000.f * std::pow(2.f, static_cast<float>(c) - 0.5f * static_cast<float>(numBands - 2u));
+
+    allocateStages();
+    updateCoeffs();
+}
+
+Crossover::~Crossover()
+{
+}
+
+void Crossover::clear()
+{
+    std::fill(states.begin(), states.end(), 0.f);
+}
+
+void Crossover::prepare(double newSampleRate, unsigned int maxNumChannels)
+{
+    allocatedChannels = maxNumChannels;
+    allocateStages();
+
+    sampleRate = std::fmax(newSampleRate, 1.0);
+    coeffsDirty = true;
+    updateCoeffs();
+}
+
+void Crossover::setCrossoverFrequency(unsigned int crossover, float frequency)
+{
+    if (crossover < frequencies.size())
+    {
+        frequencies[crossover] = std::fmax(frequency, 2.f);
+        coeffsDirty = true;
+    }
+}
+
+void Crossover::process(float* const* const* bandOutput, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    updateCoeffs();
+
+    numChannels = std::min(numChannels, allocatedChannels);
+    const unsigned int lastBand { numBands - 1u };
+
+    for (unsigned int n = 0; n < numSamples; n += ChunkSize)
+    {
+        const unsigned int chunkSamples { std::min(numSamples - n, ChunkSize) };
+
+        // The high pass of every stage runs in place in the last band, which feeds the next stage
+        for (unsigned int stage = 0; stage < numBands - 1u; ++stage)
+        {
+            std::fill(laneInput.begin(), laneInput.end(), silence.data());
+            std::fill(laneOutput.begin(), laneOutput.end(), discard.data());
+
+            for (unsigned int ch = 0; ch < numChannels; ++ch)
+            {
+                const float* stageInput { stage == 0 ? input[ch] + n : bandOutput[lastBand][ch] + n };
+
+                laneInput[2u * ch] = stageInput;
+                laneOutput[2u * ch] = bandOutput[stage][ch] + n;
+                laneInput[2u * ch + 1u] = stageInput;
+                laneOutput[2u * ch + 1u] = bandOutput[lastBand][ch] + n;
+
+                for (unsigned int band = 0; band < stage; ++band)
+                {
+                    laneInput[(2u + band) * allocatedChannels + ch] = bandOutput[band][ch] + n;
+                    laneOutput[(2u + band) * allocatedChannels + ch] = bandOutput[band][ch] + n;
+                }
+            }
+
+            processStage(stage, chunkSamples);
+        }
+    }
+}
+
+void Crossover::allocateStages()
+{
+    stageOffsets.resize(numBands - 1u);
+    stageLanes.resize(numBands - 1u);
+
+    unsigned int totalLanes { 0 };
+    for (unsigned int stage = 0; stage < numBands - 1u; ++stage)
+    {
+        stageOffsets[stage] = totalLanes;
+        stageLanes[stage] = ((2u + stage) * allocatedChannels + Simd::Lanes - 1u) / Simd::Lanes * Simd::Lanes;
+        totalLanes += stageLanes[stage];
+    }
+
+    coeffs.assign(totalLanes * CoeffsPerLane, 0.f);
+    states.assign(totalLanes * StatesPerLane, 0.f);
+    laneInput.assign(stageLanes.back(), nullptr);
+    laneOutput.assign(stageLanes.back(), nullptr);
+    silence.assign(ChunkSize, 0.f);
+    discard.assign(ChunkSize, 0.f);
+    coeffsDirty = true;
+}
+
+void Crossover::updateCoeffs()
+{
+    if (!coeffsDirty)
+        return;
+
+    coeffsDirty = false;
+
+    // An LR4 half is two identical Butterworth sections
+    ParametricEqualizer::Band butterworth[2];
+    butterworth[0].type = ParametricEqualizer::LowPass;
+    butterworth[1].type = ParametricEqualizer::HighPass;
+
+    for (unsigned int stage = 0; stage < numBands - 1u; ++stage)
+    {
+        butterworth[0].freq = frequencies[stage];
+        butterworth[1].freq = frequencies[stage];
+        butterworth[0].reso = butterworth[1].reso = static_cast<float>(M_SQRT1_2);
+
+        float designed[2 * Biquad::CoeffsPerSection];
+        ParametricEqualizer::calculateCoeffs(butterworth, 2, sampleRate, designed);
+        const float* lowPass { designed };
+        const float* highPass { designed + Biquad::CoeffsPerSection };
+
+        // LP^2 + HP^2 of the same Butterworth denominator is the allpass with its reversed polynomial
+        const float allPass[Biquad::CoeffsPerSection] { lowPass[4], lowPass[3], 1.f, lowPass[3], lowPass[4] };
+        const float identity[Biquad::CoeffsPerSection] { 1.f, 0.f, 0.f, 0.f, 0.f };
+
+        const unsigned int numLanes { stageLanes[stage] };
+        float* stageCoeffs { coeffs.data() + stageOffsets[stage] * CoeffsPerLane };
+
+        for (unsigned int lane = 0; lane < (2u + stage) * allocatedChannels; ++lane)
+        {
+            const bool isAllPass { lane >= 2u * allocatedChannels };
+            const float* section0 { isAllPass ? allPass : lane % 2u == 0 ? lowPass : highPass };
+            const float* section1 { isAllPass ? identity : section0 };
+
+            for (unsigned int c = 0; c < Biquad::CoeffsPerSection; ++c)
+            {
+                stageCoeffs[c * numLanes + lane] = section0[c];
+                stageCoeffs[(Biquad::CoeffsPerSection + c) * numLanes + lane] = section1[c];
+            }
+        }
+    }
+}
+
+void Crossover::processStage(unsigned int stage, unsigned int numSamples)
+{
+    using Simd::Float4;
+
+    const unsigned int numLanes { stageLanes[stage] };
+    const float* stageCoeffs { coeffs.data() + stageOffsets[stage] * CoeffsPerLane };
+    float* stageStates { states.data() + stageOffsets[stage] * StatesPerLane };
+
+    for (unsigned int lane = 0; lane < numLanes; lane += Simd::Lanes)
+    {
+        const float* const* input { laneInput.data() + lane };
+        float* const* output { laneOutput.data() + lane };
+
+        bool isActive[Simd::Lanes];
+        for (unsigned int l = 0; l < Simd::Lanes; ++l)
+            isActive[l] = output[l] != discard.data();
+
+        // Groups without a processed channel keep their states untouched
+        if (std::none_of(isActive, isActive + Simd::Lanes, [] (bool active) { return active; }))
+            continue;
+
+        // Coeffs and states stay in registers for the whole chunk
+        Float4 c[CoeffsPerLane];
+        for (unsigned int k = 0; k < CoeffsPerLane; ++k)
+            c[k] = Float4::load(stageCoeffs + k * numLanes + lane);
+
+        Float4 s[StatesPerLane];
+        for (unsigned int k = 0; k < StatesPerLane; ++k)
+            s[k] = Float4::load(stageStates + k * numLanes + lane);
+
+        float y[Simd::Lanes];
+
+        // A low pass and high pass pair shares a group, so both read the input before the high pass writes it
+        for (unsigned int n = 0; n < numSamples; ++n)
+        {
+            const Float4 x0 { Float4::set(input[0][n], input[1][n], input[2][n], input[3][n]) };
+            const Float4 y0 { c[0] * x0 + s[0] };
+            s[0] = c[1] * x0 - c[3] * y0 + s[1];
+            s[1] = c[2] * x0 - c[4] * y0;
+
+            const Float4 y1 { c[5] * y0 + s[2] };
+            s[2] = c[6] * y0 - c[8] * y1 + s[3];
+            s[3] = c[7] * y0 - c[9] * y1;
+
+            y1.store(y);
+            for (unsigned int l = 0; l < Simd::Lanes; ++l)
+                output[l][n] = y[l];
+        }
+
+        // Idle lanes sharing the group keep their previous states
+        for (unsigned int k = 0; k < StatesPerLane; ++k)
+        {
+            float* laneStates { stageStates + k * numLanes + lane };
+            s[k].store(y);
+            for (unsigned int l = 0; l < Simd::Lanes; ++l)
+                if (isActive[l])
+                    laneStates[l] = y[l];
+        }
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Biquad.h"
+#include "Simd.h"
+
+#include <vector>
+
+namespace DSP
+{
+
+// Linkwitz-Riley 4th order multiband crossover
+// Splits the input into 2 to MaxBands bands that sum back to an allpass response
+// Every crossover runs the low pass and high pass of its input and the allpass phase
+// compensation of the bands below it side by side: all filters of a stage and all
+// channels are lanes of one transposed direct form II kernel with per lane coeffs
+// The input is read once and the band buffers double as the intermediate buffers
+class Crossover
+{
+public:
+    static constexpr unsigned int MaxBands { 5 };
+
+    // Main ctor
+    // Requires number of bands and channels to be allocated
+    // The number of bands cannot be modified later but channels can be reallocated
+    // Crossover frequencies are initialised to octaves spread around 1 kHz
+    Crossover(unsigned int numOfBands, unsigned int maxNumChannels = 2);
+
+    // Dtor
+    ~Crossover();
+
+    // No default ctor
+    Crossover() = delete;
+
+    // No copy semantics
+    Crossover(const Crossover&) = delete;
+    const Crossover& operator=(const Crossover&) = delete;
+
+    // No move semantics
+    Crossover(Crossover&&) = delete;
+    const Crossover& operator=(Crossover&&) = delete;
+
+    // Clear states
+    void clear();
+
+    // Clear states, recalculate coeffs to new sample rate and reallocate channels
+    void prepare(double sampleRate, unsigned int maxNumChannels);
+
+    // Set the frequency in Hz between band and band + 1
+    // Frequencies must be increasing with the crossover index
+    // Changes take effect at the next process call
+    void setCrossoverFrequency(unsigned int crossover, float frequency);
+
+    // Split audio buffers into bands
+    // bandOutput[band][channel] must hold numSamples samples for every band and processed channel,
+    // any of the band buffers can be the input buffer
+    // This method can be called with a lower number of channels than allocated
+    void process(float* const* const* bandOutput, const float* const* input, unsigned int numChannels, unsigned int numSamples);
+
+    // return the number of bands
+    unsigned int getNumBands() const noexcept { return numBands; }
+
+    // return the number of currently allocated channels
+    unsigned int getAllocatedChannels() const noexcept { return allocatedChannels; }
+
+private:
+    unsigned int numBands { 0 };
+    unsigned int allocatedChannels { 0 };
+
+    // Current sample rate of coefficients
+    double sampleRate { 48000.0 };
+
+    std::vector<float> frequencies;
+    bool coeffsDirty { true };
+
+    // Every lane of a stage runs two sections, an LR4 half is two Butterworth sections,
+    // an allpass lane runs the allpass and an identity section
+    static const unsigned int SectionsPerLane { 2 };
+    static const unsigned int CoeffsPerLane { SectionsPerLane * Biquad::CoeffsPerSection };
+    static const unsigned int StatesPerLane { SectionsPerLane * 2 };
+
+    // Stage k runs the low pass and high pass of every channel and the allpass
+    // of every channel of each of the k bands below
+    // [ch0_lp, ch0_hp, ch1_lp, ch1_hp, ... , band0_ch0_ap, band0_ch1_ap, ... , band1_ch0_ap, ...]
+    std::vector<unsigned int> stageOffsets;
+    std::vector<unsigned int> stageLanes;
+
+    // coeffs of all stages in structure of arrays layout, lanes padded to a multiple of Simd::Lanes
+    // [stage0: sec0_b0_lane0, ... , sec0_b0_laneN, sec0_b1_lane0, ... , sec1_a2_laneN, stage1: ...]
+    std::vector<float> coeffs;
+
+    // states of all stages in the same layout
+    // [stage0: sec0_z1_lane0, ... , sec0_z1_laneN, sec0_z2_lane0, ... , sec1_z2_laneN, stage1: ...]
+    std::vector<float> states;
+
+    // Samples every stage runs per pass, so a chunk of all bands stays in cache between stages
+    static constexpr unsigned int ChunkSize { 64 };
+
+    // Per lane source and destination of the stage being processed
+    // Idle lanes read silence and write to the discard buffer
+    std::vector<const float*> laneInput;
+    std::vector<float*> laneOutput;
+    std::vector<float> silence;
+    std::vector<float> discard;
+
+    // Lay out stage storage for the current number of bands and channels
+    void allocateStages();
+
+    // Design all stages if any crossover frequency changed
+    void updateCoeffs();
+
+    // Run up to ChunkSize samples of all lanes of a stage over the current lane pointers
+    void processStage(unsigned int stage, unsigned int numSamples);
+};
+
+}
\ No newline at end of file
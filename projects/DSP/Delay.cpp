@@ -1,4 +1,6 @@
 #include "Delay.h"
+#include "FastMath.h"
+#include "Simd.h"
 
 #include <algorithm>
 #include <cmath>
@@ -8,20 +10,22 @@ namespace DSP
 
 Delay::Delay(float maxTimeMs, unsigned int numChannels) :
     delayLine(static_cast<unsigned int>(std::ceil(std::fmax(maxTimeMs, 1.f) * static_cast<float>(0.001 * sampleRate))), numChannels),
-    filter(1),
     preDistortionRamp(0.02f),
     postDistortionRamp(0.02f),
     timeRamp(0.5f),
     wowRamp(0.02f),
-    feedbackRamp(0.02f)
+    feedbackRamp(0.02f),
+    wowLfo(MaxChannels)
 {
+    wowLfo.setFrequency(WowFreqHz);
+    wowLfo.setPhaseOffset(1, 0.25f);
 }
 
 Delay::~Delay()
 {
 }
 
-void Delay::prepare(double newSampleRate, float maxTimeMs, unsigned int numChannels)
+void Delay::prepare(double newSampleRate, float maxTimeMs, unsigned int /*numChannels*/)
 {
     sampleRate = newSampleRate;
 
@@ -31,7 +35,7 @@ void Delay::prepare(double newSampleRate, float maxTimeMs, unsigned int numChann
     filter.setBandType(0, ParametricEqualizer::LowPass);
     filter.setBandResonance(0, static_cast<float>(M_SQRT1_2));
     filter.setBandFrequency(0, toneFrequency);
-    filter.prepare(sampleRate, numChannels);
+    filter.prepare(sampleRate);
 
     const auto distortionLin = std::pow(10.f, 0.05f * distortion);
     preDistortionRamp.prepare(sampleRate, true, distortionLin);
@@ -40,9 +44,7 @@ void Delay::prepare(double newSampleRate, float maxTimeMs, unsigned int numChann
     wowRamp.prepare(sampleRate, true, wow * WowDepthMax * static_cast<float>(sampleRate));
     feedbackRamp.prepare(sampleRate, true, feedback * 0.98f);
 
-    phaseState[0] = 0.f;
-    phaseState[1] = static_cast<float>(M_PI / 2.0);
-    phaseInc = static_cast<float>(2.0 * M_PI / sampleRate) * WowFreqHz;
+    wowLfo.prepare(sampleRate);
 
     clear();
 }
@@ -58,50 +60,46 @@ void Delay::clear()
 
 void Delay::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
 {
-    for (unsigned int n = 0; n < numSamples; ++n)
-    {
-        // Process LFO acording to mod type
-        float lfo[2] { 0.f, 0.f };
-
-        // squared sine modulation
-        const auto lfo_left { 0.5f + 0.5f * std::sin(phaseState[0]) };
-        const auto lfo_right { 0.5f + 0.5f * std::sin(phaseState[1]) };
-        lfo[0] = lfo_left * lfo_left;
-        lfo[1] = lfo_right * lfo_right;
+    numChannels = std::min(numChannels, MaxChannels);
 
-        // Increment and wrap phase states
-        phaseState[0] = std::fmod(phaseState[0] + phaseInc, static_cast<float>(2 * M_PI));
-        phaseState[1] = std::fmod(phaseState[1] + phaseInc, static_cast<float>(2 * M_PI));
+    for (unsigned int n = 0; n < numSamples; n += ChunkSize)
+    {
+        const unsigned int chunkSamples { std::min(numSamples - n, ChunkSize) };
 
-        // Apply wow and time ramps
-        wowRamp.applyGain(lfo, numChannels);
-        timeRamp.applySum(lfo, numChannels);
+        float mod[MaxChannels][ChunkSize];
+        float* modChannels[MaxChannels] { mod[0], mod[1] };
+        generateModulation(modChannels, numChannels, chunkSamples);
 
-        // Apply feedback ramp
-        feedbackRamp.applyGain(feedbackState, numChannels);
-
-        // Sum feedback
-        float delayIn[2] { 0.f, 0.f };
+        // On top of the 1 sample fixed delay, a block reads only samples written before it
+        // while the modulation is at least the block length, so the feedback of the whole
+        // block is known before any of it is written
+        float minMod { static_cast<float>(chunkSamples) };
         for (unsigned int ch = 0; ch < numChannels; ++ch)
-            delayIn[ch] = input[ch][n] + feedbackState[ch];
+            for (unsigned int k = 0; k < chunkSamples; ++k)
+                minMod = std::fmin(minMod, mod[ch][k]);
 
-        // Apply distortion
-        preDistortionRamp.applyGain(delayIn, numChannels);
-        float delayInDistortion[2];
-        for (unsigned int ch = 0; ch < numChannels; ++ch)
-            delayInDistortion[ch] = std::tanh(delayIn[ch]);
-        postDistortionRamp.applyGain(delayInDistortion, numChannels);
+        const unsigned int blockSize { static_cast<unsigned int>(std::fmax(minMod, 0.f)) };
+        const bool useBlocks { blockSize >= MinBlockSize };
 
-        // Apply tone filter
-        float delayInDistortionFilter[2] { 0.f, 0.f };
-        filter.process(delayInDistortionFilter, delayInDistortion, numChannels);
+        for (unsigned int k = 0; k < chunkSamples; k += useBlocks ? blockSize : chunkSamples)
+        {
+            const unsigned int blockSamples { useBlocks ? std::min(chunkSamples - k, blockSize) : chunkSamples };
 
-        // Process delay
-        delayLine.process(feedbackState, delayInDistortionFilter, lfo, numChannels);
+            float* blockOutput[MaxChannels];
+            const float* blockInput[MaxChannels];
+            const float* blockMod[MaxChannels];
+            for (unsigned int ch = 0; ch < numChannels; ++ch)
+            {
+                blockOutput[ch] = output[ch] + n + k;
+                blockInput[ch] = input[ch] + n + k;
+                blockMod[ch] = mod[ch] + k;
+            }
 
-        // Write to output buffers
-        for (unsigned int ch = 0; ch < numChannels; ++ch)
-            output[ch][n] = feedbackState[ch];
+            if (useBlocks)
+                processBlock(blockOutput, blockInput, blockMod, numChannels, blockSamples);
+            else
+                processSamples(blockOutput, blockInput, blockMod, numChannels, blockSamples);
+        }
     }
 }
 
@@ -137,4 +135,130 @@ void Delay::setDistortion(float distortionDb)
     postDistortionRamp.setTarget(2.f / distortionLin);
 }
 
+void Delay::setInterpolation(DelayLine::Interpolation newInterpolation)
+{
+    delayLine.setInterpolation(newInterpolation);
+}
+
+void Delay::setFastMath(bool useFastMath)
+{
+    fastMath = useFastMath;
+}
+
+void Delay::generateModulation(float* const* mod, unsigned int numChannels, unsigned int numSamples)
+{
+    using Simd::Float4;
+
+    wowLfo.process(mod, numChannels, numSamples);
+
+    // squared sine modulation, whole groups of Simd::Lanes then the samples past the last one
+    const unsigned int vectorSamples { numSamples / Simd::Lanes * Simd::Lanes };
+    const Float4 half { Float4::broadcast(0.5f) };
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        for (unsigned int n = 0; n < vectorSamples; n += Simd::Lanes)
+        {
+            const Float4 lfo { half + half * Float4::load(mod[ch] + n) };
+            (lfo * lfo).store(mod[ch] + n);
+        }
+
+        for (unsigned int n = vectorSamples; n < numSamples; ++n)
+        {
+            const float lfo { 0.5f + 0.5f * mod[ch][n] };
+            mod[ch][n] = lfo * lfo;
+        }
+    }
+
+    // Apply wow and time ramps
+    wowRamp.applyGain(mod, numChannels, numSamples);
+    timeRamp.applySum(mod, numChannels, numSamples);
+}
+
+void Delay::processBlock(float* const* output, const float* const* input, const float* const* mod,
+                         unsigned int numChannels, unsigned int numSamples)
+{
+    float wet[MaxChannels][ChunkSize];
+    float feed[MaxChannels][ChunkSize];
+    float* wetChannels[MaxChannels] { wet[0], wet[1] };
+    float* feedChannels[MaxChannels] { feed[0], feed[1] };
+
+    // All reads of the block were written before it
+    delayLine.read(wetChannels, mod, numChannels, numSamples);
+
+    // Every sample feeds back the output of the one before
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        feed[ch][0] = feedbackState[ch];
+        std::copy(wet[ch], wet[ch] + numSamples - 1u, feed[ch] + 1);
+    }
+
+    // Apply feedback ramp and sum feedback
+    feedbackRamp.applyGain(feedChannels, numChannels, numSamples);
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        for (unsigned int n = 0; n < numSamples; ++n)
+            feed[ch][n] += input[ch][n];
+
+    // Apply distortion
+    preDistortionRamp.applyGain(feedChannels, numChannels, numSamples);
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        unsigned int n { 0 };
+        if (fastMath)
+            for (; n + Simd::Lanes <= numSamples; n += Simd::Lanes)
+                FastMath::tanh(Simd::Float4::load(feed[ch] + n)).store(feed[ch] + n);
+
+        for (; n < numSamples; ++n)
+            feed[ch][n] = fastMath ? FastMath::tanh(feed[ch][n]) : std::tanh(feed[ch][n]);
+    }
+    postDistortionRamp.applyGain(feedChannels, numChannels, numSamples);
+
+    // Apply tone filter
+    filter.process(feedChannels, feedChannels, numChannels, numSamples);
+
+    // Write the block behind the reads, the input has been read so processing can be in place
+    delayLine.write(feedChannels, numChannels, numSamples);
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        feedbackState[ch] = wet[ch][numSamples - 1u];
+        std::copy(wet[ch], wet[ch] + numSamples, output[ch]);
+    }
+}
+
+void Delay::processSamples(float* const* output, const float* const* input, const float* const* mod,
+                           unsigned int numChannels, unsigned int numSamples)
+{
+    for (unsigned int n = 0; n < numSamples; ++n)
+    {
+        float delayMod[2] { 0.f, 0.f };
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+            delayMod[ch] = mod[ch][n];
+
+        // Apply feedback ramp
+        feedbackRamp.applyGain(feedbackState, numChannels);
+
+        // Sum feedback
+        float delayIn[2] { 0.f, 0.f };
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+            delayIn[ch] = input[ch][n] + feedbackState[ch];
+
+        // Apply distortion
+        preDistortionRamp.applyGain(delayIn, numChannels);
+        float delayInDistortion[2];
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+            delayInDistortion[ch] = fastMath ? FastMath::tanh(delayIn[ch]) : std::tanh(delayIn[ch]);
+        postDistortionRamp.applyGain(delayInDistortion, numChannels);
+
+        // Apply tone filter
+        float delayInDistortionFilter[2] { 0.f, 0.f };
+        filter.process(delayInDistortionFilter, delayInDistortion, numChannels);
+
+        // Process delay
+        delayLine.process(feedbackState, delayInDistortionFilter, delayMod, numChannels);
+
+        // Write to output buffers
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+            output[ch][n] = feedbackState[ch];
+    }
+}
+
 }
\ No newline at end of file
@@ -1,7 +1,8 @@
 #pragma once
 
 #include "DelayLine.h"
-#include "ParametricEqualizer.h"
+#include "FixedParametricEqualizer.h"
+#include "Lfo.h"
 #include "Ramp.h"
 
 namespace DSP
@@ -25,6 +26,7 @@ public:
     const Delay& operator=(Delay&&) = delete;
 
     // Update sample rate, reallocates and clear internal buffers
+    // Buffers always hold MaxChannels, numChannels is kept for the callers
     void prepare(double sampleRate, float maxTimeMs, unsigned int numChannels);
 
     // Clear contents of internal buffer
@@ -48,11 +50,25 @@ public:
     // Set distortion in dB
     void setDistortion(float distortionDb);
 
+    // Set the interpolation of the modulated delay, higher quality kernels cost more CPU
+    void setInterpolation(DelayLine::Interpolation newInterpolation);
+
+    // Run the drive on the FastMath approximation instead of the standard library
+    void setFastMath(bool useFastMath);
+
 private:
+    static constexpr unsigned int MaxChannels { 2 };
+
+    // Samples of modulation generated per pass
+    static constexpr unsigned int ChunkSize { 64 };
+
+    // Shortest block worth running the feedback over whole vectors, shorter delays run per sample
+    static constexpr unsigned int MinBlockSize { 8 };
+
     double sampleRate { 48000.0 };
 
     DSP::DelayLine delayLine;
-    DSP::ParametricEqualizer filter;
+    DSP::FixedParametricEqualizer<1, MaxChannels> filter;
 
     DSP::Ramp<float> preDistortionRamp;
     DSP::Ramp<float> postDistortionRamp;
@@ -60,19 +76,32 @@ private:
     DSP::Ramp<float> wowRamp;
     DSP::Ramp<float> feedbackRamp;
 
+    // Channel 1 runs a quarter cycle behind channel 0
+    DSP::Lfo wowLfo;
+
     float feedbackState[2] { 0.f, 0.f };
-    float phaseState[2] { 0.f, 0.f };
-    float phaseInc { 0.f };
 
     float delayTimeMs { 0.f };
     float feedback { 0.f };
     float wow { 0.f };
     float toneFrequency { 5000.f };
     float distortion { 0.f };
+    bool fastMath { false };
 
     static constexpr float WowFreqHz { 2.f };
     static constexpr float WowDepthMax { 0.002f };
-    static constexpr float MaxChannels { 2 };
+
+    // Generate the delay time in samples of every sample, on top of the 1 sample fixed delay
+    // mod rows must hold ChunkSize samples
+    void generateModulation(float* const* mod, unsigned int numChannels, unsigned int numSamples);
+
+    // Run the feedback loop over a block, the modulation must be at least numSamples
+    void processBlock(float* const* output, const float* const* input, const float* const* mod,
+                      unsigned int numChannels, unsigned int numSamples);
+
+    // Run the feedback loop sample by sample, for delays shorter than MinBlockSize
+    void processSamples(float* const* output, const float* const* input, const float* const* mod,
+                        unsigned int numChannels, unsigned int numSamples);
 };
 
 }
\ No newline at end of file
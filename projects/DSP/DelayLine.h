@@ -1,14 +1,49 @@
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 namespace DSP
 {
 
+// Multichannel delay line
+// The buffer is rounded up to a power of two so indices wrap with a bitmask, and the
+// first GuardSamples samples are mirrored past its end, so a modulated read can take
+// neighbouring samples without wrapping
+// Fixed delay processing moves whole blocks with at most two copies per wrap
+// All channels live in one cache line aligned allocation, either channel after channel
+// or frame after frame, and prepare only allocates when the storage has to grow
+// Lines of at least MappedStorageMinBytes map anonymous virtual memory instead of the heap,
+// its pages are zero until written, so preparing or clearing a long line does not touch
+// its samples and only the part the write head reached becomes resident
 class DelayLine
 {
 public:
-    DelayLine(unsigned int maxLengthSamples, unsigned int numChannels);
+    // Storage layout of the channels
+    // Planar keeps every channel contiguous, best for block processing
+    // Interleaved keeps every frame contiguous, best for single sample processing of many channels
+    enum Layout : unsigned int
+    {
+        Planar,
+        Interleaved
+    };
+
+    // Interpolation of the modulated delay
+    // Per sample cost of the kernels and error of a sine at 0.05 / 0.15 of the sample rate
+    //  - Linear: 2 reads, 4 flops, -38 / -19 dB, dulls the highs when not modulated
+    //  - Hermite: 4 reads, 19 flops, -66 / -35 dB, cubic Catmull-Rom
+    //  - Lagrange: 4 reads, 20 flops, -73 / -35 dB, third order
+    //  - Thiran: 2 reads, 1 division, 6 flops, -53 / -25 dB, first order allpass with a flat
+    //    magnitude, its error is phase only, recursive so only the coeffs run Simd::Lanes at a time
+    enum Interpolation : unsigned int
+    {
+        Linear = 0,
+        Hermite,
+        Lagrange,
+        Thiran
+    };
+
+    DelayLine(unsigned int maxLengthSamples, unsigned int numChannels, Layout storageLayout = Planar);
     ~DelayLine();
 
     // No default ctor
@@ -22,10 +57,14 @@ public:
     DelayLine(DelayLine&&) = delete;
     const DelayLine& operator=(DelayLine&&) = delete;
 
+    // Number of samples mirrored past the end of the buffer
+    static constexpr unsigned int GuardSamples { 4 };
+
     // Clear the contents of the delay buffer
     void clear();
 
-    // Reallocate delay buffer for the new channel count and clear its contents
+    // Resize delay buffer for the new length and channel count and clear its contents
+    // The layout is kept and existing storage is reused when it is large enough
     void prepare(unsigned int maxLengthSamples, unsigned int numChannels);
 
     // Process audio with the currently (fixed) set delay time
@@ -37,20 +76,104 @@ public:
     // Process audio thru the delay line with audio rate modulation
     // The modulation input is a audio rate signal with the time modulation in samples
     // on top of the currently set delay time
-    // The modulation input supports fractional values and uses linear interpolation
+    // The modulation input supports fractional values and uses the selected interpolation
+    // Input is written before the output is read, so interpolation can use the sample
+    // being written and delays of 1 sample stay valid
+    // Samples are processed in groups of Simd::Lanes whose input is written before any is read,
+    // so the delay time plus modulation has to stay below getBufferSize() - 5 samples for the
+    // four point kernels and getBufferSize() - 4 for Linear and Thiran
+    // The modulation is clamped to getBufferSize() - 6 samples minus the delay time
     void process(float* const* audioOutput, const float* const* audioInput, const float* const* modInput,
                  unsigned int numChannels, unsigned int numSamples);
 
     // Single sample flavour of the modulated delay time processing
     void process(float* audioOutput, const float* audioInput, const float* modInput, unsigned int numChannels);
 
+    // Read the modulated delay of the next numSamples samples without writing them, the write index
+    // is not advanced, so the block can be written afterwards, e.g. after feeding it back
+    // Every read must reach only samples written before, the four point kernels take the sample
+    // after the delayed one, so the delay time plus modulation must be at least numSamples + 1
+    void read(float* const* audioOutput, const float* const* modInput, unsigned int numChannels, unsigned int numSamples);
+
+    // Write audio without reading it back, for readers of the channel data such as MultiTapDelay
+    void write(const float* const* input, unsigned int numChannels, unsigned int numSamples);
+
     // Set the current delay time in samples
     void setDelaySamples(unsigned int samples);
 
+    // Select the interpolation of the modulated processing
+    // Calling this method will clear the allpass states
+    void setInterpolation(Interpolation newInterpolation);
+
+    // return the interpolation of the modulated processing
+    Interpolation getInterpolation() const noexcept { return interpolation; }
+
+    // return the allocated buffer size, a power of two
+    unsigned int getBufferSize() const noexcept { return bufferSize; }
+
+    // return the storage layout
+    Layout getLayout() const noexcept { return layout; }
+
+    // Read access to the samples of a channel
+    // Sample index is at getChannelData(channel)[index * getFrameStride()], the first GuardSamples
+    // samples are mirrored past getBufferSize() and the next sample is written at getWriteIndex()
+    const float* getChannelData(unsigned int channel) const noexcept { return delayBuffer + channel * channelStride; }
+    unsigned int getFrameStride() const noexcept { return frameStride; }
+    unsigned int getWriteIndex() const noexcept { return writeIndex; }
+
 private:
-    std::vector<std::vector<float>> delayBuffer;
+    // Alignment of the storage in bytes
+    static constexpr unsigned int CacheLineSize { 64 };
+
+    // Size from which the storage is mapped instead of allocated, 1 MiB
+    static constexpr std::size_t MappedStorageMinBytes { std::size_t { 1 } << 20 };
+
+    // Backing storage, over allocated by a cache line so its data can be aligned
+    std::vector<float> storage;
+
+    // Backing storage of long lines, null while the line is on the heap
+    float* mappedStorage { nullptr };
+    std::size_t mappedBytes { 0 };
+
+    // Aligned start of the used storage
+    // Sample index of a channel is at delayBuffer[channel * channelStride + index * frameStride],
+    // every channel holds bufferSize + GuardSamples samples
+    float* delayBuffer { nullptr };
+    unsigned int channelStride { 0 };
+    unsigned int frameStride { 0 };
+    unsigned int allocatedChannels { 0 };
+    Layout layout { Planar };
+
+    unsigned int maxLength { 0 };
+    unsigned int bufferSize { 0 };
+    unsigned int bufferMask { 0 };
     unsigned int delaySamples { 0 };
     unsigned int writeIndex { 0 };
+
+    Interpolation interpolation { Linear };
+
+    // Previous output of the Thiran allpass per channel
+    std::vector<float> allpassStates;
+
+    // Allocate and clear the buffers
+    void allocate(unsigned int maxLengthSamples, unsigned int numChannels);
+
+    // Write one sample of a channel, mirroring it into the guard
+    void write(float* buffer, unsigned int index, float x);
+
+    // Largest modulation the kernels can read with the current delay time
+    float getMaxModulation() const;
+
+    // Read a sample of a channel delayed by readIndex plus m samples with the selected interpolation
+    float readInterpolated(const float* buffer, unsigned int readIndex, float m, float& allpassState) const;
+
+    // Run modulated audio of a channel thru the delay line with the selected interpolation
+    // A null input only reads
+    void processModulatedChannel(unsigned int channel, float* output, const float* input, const float* mod, unsigned int numSamples);
+
+    // Run modulated audio of a channel thru the delay line, Simd::Lanes samples at a time
+    template<Interpolation kernel>
+    void processModulated(unsigned int channel, float* output, const float* input, const float* mod, unsigned int numSamples);
 };
 
 }
\ No newline at end of file
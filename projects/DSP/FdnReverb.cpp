@@ -0,0 +1,286 @@
+#include "FdnReverb.h"
+#include "Biquad.h"
+#include "ParametricEqualizer.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DSP
+{
+
+namespace
+{
+    // Round to a power of two between MinLines and MaxLines
+    unsigned int roundNumLines(unsigned int numLines)
+    {
+        unsigned int lines { FdnReverb::MinLines };
+        while (lines < numLines && lines < FdnReverb::MaxLines)
+            lines *= 2;
+
+        return lines;
+    }
+
+    bool isPrime(unsigned int n)
+    {
+        if (n < 2)
+            return false;
+
+        for (unsigned int d = 2; d * d <= n; ++d)
+            if (n % d == 0)
+                return false;
+
+        return true;
+    }
+}
+
+FdnReverb::FdnReverb(unsigned int numOfLines, float newMaxSizeMs) :
+    numLines { roundNumLines(numOfLines) },
+    maxSizeMs { std::fmax(newMaxSizeMs, 1.f) },
+    sizeMs { maxSizeMs },
+    delayLine(static_cast<unsigned int>(std::ceil(maxSizeMs * static_cast<float>(0.001 * sampleRate))) + 1u, numLines),
+    lineLengths(numLines, 1u),
+    dampingCoeffs(numLines * Biquad::CoeffsPerSection, 0.f),
+    dampingStates(numLines * 2u, 0.f),
+    lineBlock(numLines * MaxBlockSize, 0.f),
+    lineRows(numLines, nullptr)
+{
+    for (unsigned int line = 0; line < numLines; ++line)
+        lineRows[line] = lineBlock.data() + line * MaxBlockSize;
+
+    updateLines();
+}
+
+FdnReverb::~FdnReverb()
+{
+}
+
+void FdnReverb::prepare(double newSampleRate, float newMaxSizeMs)
+{
+    sampleRate = newSampleRate;
+    maxSizeMs = std::fmax(newMaxSizeMs, 1.f);
+    sizeMs = std::fmin(sizeMs, maxSizeMs);
+
+    delayLine.prepare(static_cast<unsigned int>(std::ceil(maxSizeMs * static_cast<float>(0.001 * sampleRate))) + 1u, numLines);
+
+    linesDirty = true;
+    updateLines();
+    clear();
+}
+
+void FdnReverb::clear()
+{
+    delayLine.clear();
+    std::fill(dampingStates.begin(), dampingStates.end(), 0.f);
+}
+
+void FdnReverb::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    using Simd::Float4;
+
+    updateLines();
+
+    numChannels = std::min(numChannels, MaxChannels);
+    if (numChannels == 0)
+        return;
+
+    // Every channel sums numLines / numChannels lines
+    const float channelScale { 1.f / std::sqrt(static_cast<float>(numLines / numChannels)) };
+    const Float4 mixScale { Float4::broadcast(1.f / std::sqrt(static_cast<float>(numLines))) };
+    const unsigned int blockSize { std::min(lineLengths[0], MaxBlockSize) };
+
+    for (unsigned int n = 0; n < numSamples; n += blockSize)
+    {
+        const unsigned int blockSamples { std::min(numSamples - n, blockSize) };
+
+        // Rows are MaxBlockSize long, so vector passes can round the block up to whole registers
+        const unsigned int vectorSamples { (blockSamples + Simd::Lanes - 1u) / Simd::Lanes * Simd::Lanes };
+
+        // Read the line outputs, all written before this block
+        const unsigned int bufferSize { delayLine.getBufferSize() };
+        for (unsigned int line = 0; line < numLines; ++line)
+        {
+            const float* buffer { delayLine.getChannelData(line) };
+            unsigned int readIndex { (delayLine.getWriteIndex() - lineLengths[line]) & (bufferSize - 1u) };
+            for (unsigned int done = 0; done < blockSamples;)
+            {
+                const unsigned int length { std::min(blockSamples - done, bufferSize - readIndex) };
+                std::copy(buffer + readIndex, buffer + readIndex + length, lineRows[line] + done);
+                readIndex = (readIndex + length) & (bufferSize - 1u);
+                done += length;
+            }
+        }
+
+        // Damping and decay
+        processDamping(blockSamples);
+
+        // Output taps before mixing
+        float wet[MaxChannels][MaxBlockSize] {};
+        for (unsigned int line = 0; line < numLines; ++line)
+        {
+            float* sum { wet[line % numChannels] };
+            for (unsigned int k = 0; k < vectorSamples; k += Simd::Lanes)
+                (Float4::load(sum + k) + Float4::load(lineRows[line] + k)).store(sum + k);
+        }
+
+        // Hadamard matrix, line pairs h apart at every stage
+        for (unsigned int h = 1; h < numLines; h *= 2)
+        {
+            for (unsigned int line = 0; line < numLines; ++line)
+            {
+                if ((line & h) != 0)
+                    continue;
+
+                float* a { lineRows[line] };
+                float* b { lineRows[line + h] };
+                for (unsigned int k = 0; k < vectorSamples; k += Simd::Lanes)
+                {
+                    const Float4 x { Float4::load(a + k) };
+                    const Float4 y { Float4::load(b + k) };
+                    (x + y).store(a + k);
+                    (x - y).store(b + k);
+                }
+            }
+        }
+
+        // Normalise the matrix, add the input and feed the lines back
+        for (unsigned int line = 0; line < numLines; ++line)
+        {
+            float* row { lineRows[line] };
+            const float* x { input[line % numChannels] + n };
+            for (unsigned int k = 0; k < vectorSamples; k += Simd::Lanes)
+                (Float4::load(row + k) * mixScale).store(row + k);
+
+            for (unsigned int k = 0; k < blockSamples; ++k)
+                row[k] += channelScale * x[k];
+        }
+
+        delayLine.write(lineRows.data(), numLines, blockSamples);
+
+        // The input has been read, so processing can be in place
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+            for (unsigned int k = 0; k < blockSamples; ++k)
+                output[ch][n + k] = channelScale * wet[ch][k];
+    }
+}
+
+void FdnReverb::setSize(float newSizeMs)
+{
+    sizeMs = std::fmin(std::fmax(newSizeMs, 1.f), maxSizeMs);
+    linesDirty = true;
+}
+
+void FdnReverb::setDecayTime(float newDecaySec)
+{
+    decaySec = std::fmax(newDecaySec, 0.01f);
+    linesDirty = true;
+}
+
+void FdnReverb::setDamping(float newDampingNorm)
+{
+    damping = std::fmin(std::fmax(newDampingNorm, 0.f), 1.f);
+    linesDirty = true;
+}
+
+void FdnReverb::setDampingFrequency(float newFrequencyHz)
+{
+    dampingFrequency = std::fmax(newFrequencyHz, 20.f);
+    linesDirty = true;
+}
+
+void FdnReverb::updateLines()
+{
+    if (!linesDirty)
+        return;
+
+    linesDirty = false;
+
+    // Lengths spread geometrically from MinSizeRatio of the size up to the size,
+    // moved up to the next prime that is longer than the previous line
+    const float longest { sizeMs * static_cast<float>(0.001 * sampleRate) };
+    const unsigned int maxLength { static_cast<unsigned int>(std::ceil(maxSizeMs * static_cast<float>(0.001 * sampleRate))) };
+
+    unsigned int previous { 0 };
+    for (unsigned int line = 0; line < numLines; ++line)
+    {
+        const float ratio { std::pow(MinSizeRatio, static_cast<float>(numLines - 1u - line) / static_cast<float>(numLines - 1u)) };
+        unsigned int length { std::max(static_cast<unsigned int>(std::round(longest * ratio)), previous + 1u) };
+        while (!isPrime(length) && length < maxLength)
+            ++length;
+
+        lineLengths[line] = std::min(std::max(length, 1u), maxLength);
+        previous = lineLengths[line];
+    }
+
+    // Per pass attenuation of a line in dB, broadband from the decay time and
+    // a high shelf down to the damped decay time
+    const float highDecaySec { decaySec / (1.f + 9.f * damping) };
+
+    ParametricEqualizer::Band shelf;
+    shelf.type = ParametricEqualizer::HighShelf;
+    shelf.freq = std::fmin(dampingFrequency, static_cast<float>(0.45 * sampleRate));
+
+    for (unsigned int line = 0; line < numLines; ++line)
+    {
+        const float lengthSec { static_cast<float>(lineLengths[line] / sampleRate) };
+        const float decayDb { -60.f * lengthSec / decaySec };
+        shelf.gain = -60.f * lengthSec / highDecaySec - decayDb;
+
+        const auto coeffs { ParametricEqualizer::calculateCoeffs(shelf, sampleRate) };
+        const float decayGain { std::pow(10.f, decayDb / 20.f) };
+        for (unsigned int c = 0; c < Biquad::CoeffsPerSection; ++c)
+            dampingCoeffs[c * numLines + line] = c < 3 ? coeffs[c] * decayGain : coeffs[c];
+    }
+}
+
+void FdnReverb::processDamping(unsigned int numSamples)
+{
+    using Simd::Float4;
+
+    float* z1 { dampingStates.data() };
+    float* z2 { z1 + numLines };
+
+    const float* b0 { dampingCoeffs.data() };
+    const float* b1 { b0 + numLines };
+    const float* b2 { b1 + numLines };
+    const float* a1 { b2 + numLines };
+    const float* a2 { a1 + numLines };
+
+    // numLines is a multiple of Simd::Lanes, every group runs thru the whole block
+    // with coeffs and states held in registers
+    for (unsigned int group = 0; group < numLines; group += Simd::Lanes)
+    {
+        const Float4 cb0 { Float4::load(b0 + group) };
+        const Float4 cb1 { Float4::load(b1 + group) };
+        const Float4 cb2 { Float4::load(b2 + group) };
+        const Float4 ca1 { Float4::load(a1 + group) };
+        const Float4 ca2 { Float4::load(a2 + group) };
+        Float4 s1 { Float4::load(z1 + group) };
+        Float4 s2 { Float4::load(z2 + group) };
+
+        float* r0 { lineRows[group] };
+        float* r1 { lineRows[group + 1u] };
+        float* r2 { lineRows[group + 2u] };
+        float* r3 { lineRows[group + 3u] };
+
+        for (unsigned int n = 0; n < numSamples; ++n)
+        {
+            const Float4 x { Float4::set(r0[n], r1[n], r2[n], r3[n]) };
+            const Float4 y { cb0 * x + s1 };
+            s1 = cb1 * x - ca1 * y + s2;
+            s2 = cb2 * x - ca2 * y;
+
+            float frame[Simd::Lanes];
+            y.store(frame);
+            r0[n] = frame[0];
+            r1[n] = frame[1];
+            r2[n] = frame[2];
+            r3[n] = frame[3];
+        }
+
+        s1.store(z1 + group);
+        s2.store(z2 + group);
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "DelayLine.h"
+
+#include <vector>
+
+namespace DSP
+{
+
+// Feedback delay network reverb
+// The lines are the channels of one DelayLine and feed back thru a Hadamard matrix,
+// applied as log2(lines) stages of sum and difference butterflies instead of a matrix multiply
+// Every line has a high shelf with its decay gain folded in, so all lines decay with the
+// same time at low and at high frequencies, the shelves of Simd::Lanes lines run side by
+// side as transposed direct form II sections like the FilterBank bands
+// Audio runs in blocks no longer than the shortest line: the line outputs of a block were
+// all written before it starts, so every step runs over the whole block, vectorized over time
+class FdnReverb
+{
+public:
+    static constexpr unsigned int MinLines { 4 };
+    static constexpr unsigned int MaxLines { 16 };
+    static constexpr unsigned int MaxChannels { 2 };
+
+    // Main ctor
+    // Requires the number of lines, rounded to a power of two between MinLines and MaxLines,
+    // and the maximum size in ms
+    // The number of lines cannot be modified later
+    FdnReverb(unsigned int numOfLines, float maxSizeMs);
+
+    // Dtor
+    ~FdnReverb();
+
+    // No default ctor
+    FdnReverb() = delete;
+
+    // No copy semantics
+    FdnReverb(const FdnReverb&) = delete;
+    const FdnReverb& operator=(const FdnReverb&) = delete;
+
+    // No move semantics
+    FdnReverb(FdnReverb&&) = delete;
+    const FdnReverb& operator=(FdnReverb&&) = delete;
+
+    // Update sample rate, reallocates and clear internal buffers
+    void prepare(double sampleRate, float maxSizeMs);
+
+    // Clear contents of internal buffers
+    void clear();
+
+    // Process audio, the output is the reverb only, meant for sends
+    // Line n is fed by and feeds channel n % numChannels
+    void process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples);
+
+    // Changes are not smoothed and take effect at the next process call
+
+    // Set the length of the longest line in ms, the others are spread down to MinSizeRatio of it
+    void setSize(float newSizeMs);
+
+    // Set the decay time to -60 dB of the low frequencies in seconds
+    void setDecayTime(float newDecaySec);
+
+    // Set high frequency damping normalised, 0 decays the highs as the lows and 1 ten times faster
+    void setDamping(float newDampingNorm);
+
+    // Set the damping shelf frequency in Hz
+    void setDampingFrequency(float newFrequencyHz);
+
+    // return the number of lines
+    unsigned int getNumLines() const noexcept { return numLines; }
+
+private:
+    // Shortest line length relative to the longest
+    static constexpr float MinSizeRatio { 0.4f };
+
+    // Longest block processed at once, sized for the block scratch
+    static constexpr unsigned int MaxBlockSize { 256 };
+
+    double sampleRate { 48000.0 };
+    unsigned int numLines { 0 };
+
+    float maxSizeMs { 0.f };
+    float sizeMs { 0.f };
+    float decaySec { 2.f };
+    float damping { 0.5f };
+    float dampingFrequency { 4000.f };
+    bool linesDirty { true };
+
+    // One channel per line
+    DelayLine delayLine;
+
+    // Line lengths in samples, increasing and prime so the echoes do not line up
+    std::vector<unsigned int> lineLengths;
+
+    // High shelf coeffs of all lines in structure of arrays layout
+    // [b0_line0, ... , b0_lineN, b1_line0, ... , b1_lineN, b2_line0, ... , a2_lineN]
+    std::vector<float> dampingCoeffs;
+
+    // Shelf states, [z1_line0, ... , z1_lineN, z2_line0, ... , z2_lineN]
+    std::vector<float> dampingStates;
+
+    // Block of every line, one row of MaxBlockSize samples per line
+    std::vector<float> lineBlock;
+    std::vector<float*> lineRows;
+
+    // Recalculate line lengths and damping if any setting changed
+    void updateLines();
+
+    // Run the line rows of a block thru their shelves in place
+    void processDamping(unsigned int numSamples);
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "Fft.h"
+#include "Simd.h"
+
+#include <cmath>
+
+namespace DSP
+{
+
+Fft::Fft(unsigned int size_) :
+    size { size_ },
+    halfSize { size_ / 2 },
+    bitReversed(halfSize, 0),
+    twiddleReal(halfSize, 0.f),
+    twiddleImag(halfSize, 0.f),
+    stageTwiddleReal(halfSize, 0.f),
+    stageTwiddleImag(halfSize, 0.f),
+    workReal(halfSize, 0.f),
+    workImag(halfSize, 0.f)
+{
+    unsigned int numBits { 0 };
+    while ((1u << numBits) < halfSize)
+        ++numBits;
+
+    for (unsigned int n = 0; n < halfSize; ++n)
+    {
+        unsigned int reversed { 0 };
+        for (unsigned int b = 0; b < numBits; ++b)
+            reversed |= ((n >> b) & 1u) << (numBits - 1u - b);
+
+        bitReversed[n] = reversed;
+    }
+
+    for (unsigned int k = 0; k < halfSize; ++k)
+    {
+        const double phase { -2.0 * M_PI * static_cast<double>(k) / static_cast<double>(size) };
+        twiddleReal[k] = static_cast<float>(std::cos(phase));
+        twiddleImag[k] = static_cast<float>(std::sin(phase));
+    }
+
+    for (unsigned int length = 2; length <= halfSize; length *= 2)
+    {
+        const unsigned int halfLength { length / 2 };
+        for (unsigned int j = 0; j < halfLength; ++j)
+        {
+            stageTwiddleReal[halfLength - 1 + j] = twiddleReal[j * (size / length)];
+            stageTwiddleImag[halfLength - 1 + j] = twiddleImag[j * (size / length)];
+        }
+    }
+}
+
+Fft::~Fft()
+{
+}
+
+void Fft::forward(const float* input, float* real, float* imag)
+{
+    // Even samples to the real part, odd samples to the imaginary part
+    for (unsigned int n = 0; n < halfSize; ++n)
+    {
+        workReal[bitReversed[n]] = input[2 * n];
+        workImag[bitReversed[n]] = input[2 * n + 1];
+    }
+
+    transform(false);
+
+    // Split the spectra of the even and odd samples and combine them
+    // E[k] = (Z[k] + Z*[M - k]) / 2, O[k] = (Z[k] - Z*[M - k]) / 2i, X[k] = E[k] + W^k O[k]
+    real[0] = workReal[0] + workImag[0];
+    imag[0] = 0.f;
+    real[halfSize] = workReal[0] - workImag[0];
+    imag[halfSize] = 0.f;
+
+    for (unsigned int k = 1; k < halfSize; ++k)
+    {
+        const float zr { workReal[k] };
+        const float zi { workImag[k] };
+        const float cr { workReal[halfSize - k] };
+        const float ci { -workImag[halfSize - k] };
+
+        const float er { 0.5f * (zr + cr) };
+        const float ei { 0.5f * (zi + ci) };
+        const float odr { 0.5f * (zi - ci) };
+        const float odi { -0.5f * (zr - cr) };
+
+        real[k] = er + twiddleReal[k] * odr - twiddleImag[k] * odi;
+        imag[k] = ei + twiddleReal[k] * odi + twiddleImag[k] * odr;
+    }
+}
+
+void Fft::inverse(const float* real, const float* imag, float* output)
+{
+    // E[k] = (X[k] + X*[M - k]) / 2, O[k] = (X[k] - X*[M - k]) W^-k / 2, Z[k] = E[k] + i O[k]
+    for (unsigned int k = 0; k < halfSize; ++k)
+    {
+        const float xr { real[k] };
+        const float xi { imag[k] };
+        const float cr { real[halfSize - k] };
+        const float ci { -imag[halfSize - k] };
+
+        const float er { 0.5f * (xr + cr) };
+        const float ei { 0.5f * (xi + ci) };
+        const float dr { 0.5f * (xr - cr) };
+        const float di { 0.5f * (xi - ci) };
+
+        // Multiply by the conjugate twiddle
+        const float odr { dr * twiddleReal[k] + di * twiddleImag[k] };
+        const float odi { di * twiddleReal[k] - dr * twiddleImag[k] };
+
+        workReal[bitReversed[k]] = er - odi;
+        workImag[bitReversed[k]] = ei + odr;
+    }
+
+    transform(true);
+
+    const float scale { 1.f / static_cast<float>(halfSize) };
+    for (unsigned int n = 0; n < halfSize; ++n)
+    {
+        output[2 * n] = workReal[n] * scale;
+        output[2 * n + 1] = workImag[n] * scale;
+    }
+}
+
+void Fft::transform(bool inverse)
+{
+    const float sign { inverse ? -1.f : 1.f };
+
+    for (unsigned int length = 2; length <= halfSize; length *= 2)
+    {
+        const unsigned int halfLength { length / 2 };
+        const float* stageReal { stageTwiddleReal.data() + halfLength - 1 };
+        const float* stageImag { stageTwiddleImag.data() + halfLength - 1 };
+
+        for (unsigned int start = 0; start < halfSize; start += length)
+        {
+            float* ar { workReal.data() + start };
+            float* ai { workImag.data() + start };
+            float* br { ar + halfLength };
+            float* bi { ai + halfLength };
+
+            if (halfLength >= Simd::Lanes)
+            {
+                const Simd::Float4 signs { Simd::Float4::broadcast(sign) };
+                for (unsigned int j = 0; j < halfLength; j += Simd::Lanes)
+                {
+                    const Simd::Float4 wr { Simd::Float4::load(stageReal + j) };
+                    const Simd::Float4 wi { signs * Simd::Float4::load(stageImag + j) };
+                    const Simd::Float4 xr { Simd::Float4::load(br + j) };
+                    const Simd::Float4 xi { Simd::Float4::load(bi + j) };
+                    const Simd::Float4 tr { xr * wr - xi * wi };
+                    const Simd::Float4 ti { xr * wi + xi * wr };
+                    const Simd::Float4 yr { Simd::Float4::load(ar + j) };
+                    const Simd::Float4 yi { Simd::Float4::load(ai + j) };
+
+                    (yr - tr).store(br + j);
+                    (yi - ti).store(bi + j);
+                    (yr + tr).store(ar + j);
+                    (yi + ti).store(ai + j);
+                }
+            }
+            else
+            {
+                for (unsigned int j = 0; j < halfLength; ++j)
+                {
+                    const float wr { stageReal[j] };
+                    const float wi { sign * stageImag[j] };
+                    const float tr { br[j] * wr - bi[j] * wi };
+                    const float ti { br[j] * wi + bi[j] * wr };
+
+                    br[j] = ar[j] - tr;
+                    bi[j] = ai[j] - ti;
+                    ar[j] += tr;
+                    ai[j] += ti;
+                }
+            }
+        }
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+
+namespace DSP
+{
+
+// Real FFT of a power of two size
+// Spectra hold size / 2 + 1 bins in split real and imaginary arrays
+// Computed as a half size complex radix-2 FFT of the even and odd samples,
+// all tables and scratch memory are allocated in the ctor
+class Fft
+{
+public:
+    // size must be a power of two, 4 or above
+    Fft(unsigned int size);
+    ~Fft();
+
+    // No default ctor
+    Fft() = delete;
+
+    // No copy semantics
+    Fft(const Fft&) = delete;
+    const Fft& operator=(const Fft&) = delete;
+
+    // No move semantics
+    Fft(Fft&&) = delete;
+    const Fft& operator=(Fft&&) = delete;
+
+    // Forward transform of size samples, unscaled
+    void forward(const float* input, float* real, float* imag);
+
+    // Inverse transform to size samples, scaled so inverse(forward(x)) == x
+    void inverse(const float* real, const float* imag, float* output);
+
+    unsigned int getSize() const noexcept { return size; }
+    unsigned int getNumBins() const noexcept { return size / 2 + 1; }
+
+private:
+    unsigned int size { 0 };
+    unsigned int halfSize { 0 };
+
+    // Bit reversed index of every half size complex sample
+    std::vector<unsigned int> bitReversed;
+
+    // e^(-2 pi i k / size) for k below size / 2
+    std::vector<float> twiddleReal;
+    std::vector<float> twiddleImag;
+
+    // Twiddles of every butterfly stage stored contiguously, so the stages
+    // from Simd::Lanes butterflies on run vectorized
+    // [stage 2: w0, stage 4: w0, w1, stage 8: w0, w1, w2, w3, ...]
+    std::vector<float> stageTwiddleReal;
+    std::vector<float> stageTwiddleImag;
+
+    // Half size complex scratch
+    std::vector<float> workReal;
+    std::vector<float> workImag;
+
+    // In place half size complex FFT of workReal and workImag, input in bit reversed order
+    void transform(bool inverse);
+};
+
+}
\ No newline at end of file
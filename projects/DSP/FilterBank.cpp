@@ -0,0 +1,220 @@
+#include "FilterBank.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DSP
+{
+
+FilterBank::FilterBank(unsigned int numOfBands, unsigned int maxNumChannels) :
+    allocatedChannels { maxNumChannels },
+    paddedBands { (numOfBands + Simd::Lanes - 1u) / Simd::Lanes * Simd::Lanes },
+    bands(numOfBands),
+    bandCoeffs(numOfBands * DSP::Biquad::CoeffsPerSection, 0.f),
+    coeffs(paddedBands * DSP::Biquad::CoeffsPerSection, 0.f),
+    states(allocatedChannels * paddedBands * 2u, 0.f)
+{
+    updateCoeffs();
+}
+
+FilterBank::~FilterBank()
+{
+}
+
+void FilterBank::clear()
+{
+    std::fill(states.begin(), states.end(), 0.f);
+}
+
+void FilterBank::prepare(double newSampleRate, unsigned int maxNumChannels)
+{
+    allocatedChannels = maxNumChannels;
+    states.resize(allocatedChannels * paddedBands * 2u);
+    clear();
+
+    sampleRate = std::fmax(newSampleRate, 1.0);
+    coeffsDirty = true;
+    updateCoeffs();
+}
+
+void FilterBank::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    updateCoeffs();
+
+    numChannels = std::min(numChannels, allocatedChannels);
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        for (unsigned int n = 0; n < numSamples; n += ChunkSize)
+        {
+            const unsigned int chunkSamples { std::min(numSamples - n, ChunkSize) };
+            processChunk(ch, input[ch] + n, chunkSamples, output[ch] + n, nullptr, 0);
+        }
+    }
+}
+
+void FilterBank::process(float* output, const float* input, unsigned int numChannels)
+{
+    updateCoeffs();
+
+    numChannels = std::min(numChannels, allocatedChannels);
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        processChunk(ch, input + ch, 1, output + ch, nullptr, 0);
+}
+
+void FilterBank::processBands(float* const* bandOutput, const float* input, unsigned int channel, unsigned int numSamples)
+{
+    updateCoeffs();
+
+    if (channel >= allocatedChannels)
+        return;
+
+    for (unsigned int n = 0; n < numSamples; n += ChunkSize)
+    {
+        const unsigned int chunkSamples { std::min(numSamples - n, ChunkSize) };
+        processChunk(channel, input + n, chunkSamples, nullptr, bandOutput, n);
+    }
+}
+
+void FilterBank::setBandType(unsigned int band, FilterType type)
+{
+    if (band < bands.size())
+    {
+        bands[band].type = type;
+        coeffsDirty = true;
+    }
+}
+
+void FilterBank::setBandFrequency(unsigned int band, float frequency)
+{
+    if (band < bands.size())
+    {
+        bands[band].freq = std::fmax(frequency, 2.f);
+        coeffsDirty = true;
+    }
+}
+
+void FilterBank::setBandResonance(unsigned int band, float resonance)
+{
+    if (band < bands.size())
+    {
+        bands[band].reso = std::fmax(resonance, 0.1f);
+        coeffsDirty = true;
+    }
+}
+
+void FilterBank::setBandGain(unsigned int band, float gain)
+{
+    if (band < bands.size())
+    {
+        bands[band].gain = gain;
+        coeffsDirty = true;
+    }
+}
+
+void FilterBank::setBand(unsigned int band, const Band& settings)
+{
+    setBandType(band, settings.type);
+    setBandFrequency(band, settings.freq);
+    setBandResonance(band, settings.reso);
+    setBandGain(band, settings.gain);
+}
+
+void FilterBank::updateCoeffs()
+{
+    if (!coeffsDirty)
+        return;
+
+    coeffsDirty = false;
+
+    const unsigned int numBands { static_cast<unsigned int>(bands.size()) };
+    ParametricEqualizer::calculateCoeffs(bands.data(), numBands, sampleRate, bandCoeffs.data());
+
+    // Padding bands stay zero so they neither ring nor add to the sum
+    for (unsigned int c = 0; c < DSP::Biquad::CoeffsPerSection; ++c)
+        for (unsigned int b = 0; b < numBands; ++b)
+            coeffs[c * paddedBands + b] = bandCoeffs[b * DSP::Biquad::CoeffsPerSection + c];
+}
+
+void FilterBank::processChunk(unsigned int channel, const float* input, unsigned int numSamples,
+                              float* sum, float* const* bandOutput, unsigned int offset)
+{
+    using Simd::Float4;
+
+    const unsigned int numBands { static_cast<unsigned int>(bands.size()) };
+
+    // Input is copied first so the sum can be written in place
+    float x[ChunkSize];
+    std::copy(input, input + numSamples, x);
+
+    // Per sample sums of every lane, reduced once all bands ran
+    float laneSums[ChunkSize * Simd::Lanes];
+    if (sum)
+        std::fill(laneSums, laneSums + numSamples * Simd::Lanes, 0.f);
+
+    float* z1 { states.data() + channel * paddedBands * 2u };
+    float* z2 { z1 + paddedBands };
+
+    const float* b0 { coeffs.data() };
+    const float* b1 { b0 + paddedBands };
+    const float* b2 { b1 + paddedBands };
+    const float* a1 { b2 + paddedBands };
+    const float* a2 { a1 + paddedBands };
+
+    // Groups of bands run thru the whole chunk with coeffs and states held in registers,
+    // two groups at a time so the recursions of both overlap
+    for (unsigned int b = 0; b < paddedBands; b += 2u * Simd::Lanes)
+    {
+        const unsigned int numGroups { std::min((paddedBands - b) / Simd::Lanes, 2u) };
+
+        Float4 cb0[2], cb1[2], cb2[2], ca1[2], ca2[2], s1[2], s2[2];
+        for (unsigned int g = 0; g < 2; ++g)
+        {
+            // A missing second group runs on zero coeffs and is not stored
+            const unsigned int group { b + std::min(g, numGroups - 1u) * Simd::Lanes };
+            const Float4 enabled { Float4::broadcast(g < numGroups ? 1.f : 0.f) };
+            cb0[g] = enabled * Float4::load(b0 + group);
+            cb1[g] = enabled * Float4::load(b1 + group);
+            cb2[g] = enabled * Float4::load(b2 + group);
+            ca1[g] = enabled * Float4::load(a1 + group);
+            ca2[g] = enabled * Float4::load(a2 + group);
+            s1[g] = enabled * Float4::load(z1 + group);
+            s2[g] = enabled * Float4::load(z2 + group);
+        }
+
+        float y[2 * Simd::Lanes];
+
+        for (unsigned int n = 0; n < numSamples; ++n)
+        {
+            const Float4 xv { Float4::broadcast(x[n]) };
+            const Float4 y0 { cb0[0] * xv + s1[0] };
+            const Float4 y1 { cb0[1] * xv + s1[1] };
+            s1[0] = cb1[0] * xv - ca1[0] * y0 + s2[0];
+            s1[1] = cb1[1] * xv - ca1[1] * y1 + s2[1];
+            s2[0] = cb2[0] * xv - ca2[0] * y0;
+            s2[1] = cb2[1] * xv - ca2[1] * y1;
+
+            if (sum)
+                (Float4::load(laneSums + n * Simd::Lanes) + y0 + y1).store(laneSums + n * Simd::Lanes);
+
+            if (bandOutput)
+            {
+                y0.store(y);
+                y1.store(y + Simd::Lanes);
+                for (unsigned int l = b; l < std::min(b + 2u * Simd::Lanes, numBands); ++l)
+                    bandOutput[l][offset + n] = y[l - b];
+            }
+        }
+
+        for (unsigned int g = 0; g < numGroups; ++g)
+        {
+            s1[g].store(z1 + b + g * Simd::Lanes);
+            s2[g].store(z2 + b + g * Simd::Lanes);
+        }
+    }
+
+    if (sum)
+        for (unsigned int n = 0; n < numSamples; ++n)
+            sum[n] = Float4::load(laneSums + n * Simd::Lanes).sum();
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "ParametricEqualizer.h"
+#include "Simd.h"
+
+#include <vector>
+
+namespace DSP
+{
+
+// Bank of independent biquad bands all fed by the same input
+// Meant for many bands at once, e.g. a 31 band graphic equalizer or a vocoder analysis bank
+// Bands use the ParametricEqualizer band types and formulas and are stored in structure of
+// arrays layout, so Simd::Lanes bands run side by side as transposed direct form II sections
+// The output is either the sum of all bands or one buffer per band
+class FilterBank
+{
+public:
+    using FilterType = ParametricEqualizer::FilterType;
+    using Band = ParametricEqualizer::Band;
+
+    // Main ctor
+    // Requires number of bands and channels to be allocated
+    // The number of bands cannot be modified later but channels can be reallocated
+    // All bands filters will be initialised to Flat
+    FilterBank(unsigned int numOfBands, unsigned int maxNumChannels = 2);
+
+    // Dtor
+    ~FilterBank();
+
+    // No default ctor
+    FilterBank() = delete;
+
+    // No copy semantics
+    FilterBank(const FilterBank&) = delete;
+    const FilterBank& operator=(const FilterBank&) = delete;
+
+    // No move semantics
+    FilterBank(FilterBank&&) = delete;
+    const FilterBank& operator=(FilterBank&&) = delete;
+
+    // Clear states
+    void clear();
+
+    // Clear states, recalculate coeffs to new sample rate and reallocate channels
+    void prepare(double sampleRate, unsigned int maxNumChannels);
+
+    // Process audio buffers, the output is the sum of all bands
+    // This method can be called with a lower number of channels than allocated
+    void process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples);
+
+    // Process audio buffers, the output is the sum of all bands
+    // Single sample flavour
+    void process(float* output, const float* input, unsigned int numChannels);
+
+    // Process one channel into one output buffer per band
+    // bandOutput must hold getNumBands buffers of numSamples samples
+    void processBands(float* const* bandOutput, const float* input, unsigned int channel, unsigned int numSamples);
+
+    // Band changes are not interpolated and take effect at the next process call,
+    // all changed bands are designed together in one batch
+
+    // Set filter type of a band
+    void setBandType(unsigned int band, FilterType type);
+
+    // Set filter frequency of a band in Hz
+    void setBandFrequency(unsigned int band, float frequency);
+
+    // Set filter resonance of a band in Q factor
+    void setBandResonance(unsigned int band, float resonance);
+
+    // Set filter gain of a band in dB
+    void setBandGain(unsigned int band, float gain);
+
+    // Set all settings of a band
+    void setBand(unsigned int band, const Band& settings);
+
+    // return the number of bands
+    unsigned int getNumBands() const noexcept { return static_cast<unsigned int>(bands.size()); }
+
+    // return the number of currently allocated channels
+    unsigned int getAllocatedChannels() const noexcept { return allocatedChannels; }
+
+private:
+    unsigned int allocatedChannels { 0 };
+
+    // bands rounded up to a multiple of Simd::Lanes
+    unsigned int paddedBands { 0 };
+
+    // Current sample rate of coefficients
+    double sampleRate { 48000.0 };
+
+    // Band settings and their designed coeffs in Biquad layout
+    std::vector<Band> bands;
+    std::vector<float> bandCoeffs;
+    bool coeffsDirty { true };
+
+    // coeffs in structure of arrays layout, padding bands are zero
+    // [b0_band0, b0_band1, ... , b0_bandN, b1_band0, ... , b1_bandN, b2_band0, ... , a2_bandN]
+    std::vector<float> coeffs;
+
+    // states of all channels, two per band
+    // [ch0_z1_band0, ... , ch0_z1_bandN, ch0_z2_band0, ... , ch0_z2_bandN, ch1_z1_band0, ...]
+    std::vector<float> states;
+
+    static constexpr unsigned int ChunkSize { 64 };
+
+    // Design all bands and transpose them to the structure of arrays layout if any changed
+    void updateCoeffs();
+
+    // Run up to ChunkSize samples of a channel thru all bands
+    // The sum of all bands is written to sum and every band to bandOutput[band] + offset,
+    // either can be null, input can be the same buffer as sum
+    void processChunk(unsigned int channel, const float* input, unsigned int numSamples,
+                      float* sum, float* const* bandOutput, unsigned int offset);
+};
+
+}
\ No newline at end of file
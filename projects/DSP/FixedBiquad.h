@@ -0,0 +1,171 @@
+#pragma once
+
+#include "Biquad.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace DSP
+{
+
+// Compile time sized flavour of Biquad
+// Coefficients and states live inside the object, so there is no heap
+// allocation and the section loop is fully unrolled by the compiler
+// Uses the same coefficient format and channel interleaved state layout as Biquad
+template<unsigned int NumSections, unsigned int MaxChannels>
+class FixedBiquad
+{
+public:
+    static_assert(NumSections > 0, "FixedBiquad needs at least one section.");
+    static_assert(MaxChannels > 0, "FixedBiquad needs at least one channel.");
+
+    static constexpr unsigned int CoeffsPerSection { Biquad::CoeffsPerSection };
+    static constexpr unsigned int StatesPerSection { Biquad::StatesPerSection };
+
+    FixedBiquad()
+    {
+        coeffs.fill(0.f);
+        states.fill(0.f);
+    }
+
+    ~FixedBiquad() { }
+
+    FixedBiquad(const FixedBiquad&) = default;
+    FixedBiquad& operator=(const FixedBiquad&) = default;
+
+    // Clear all states
+    void clear()
+    {
+        states.fill(0.f);
+    }
+
+    // Set new coeffs to a section
+    void setSectionCoeffs(const std::array<float, CoeffsPerSection>& newSectionCoeffs, unsigned int section)
+    {
+        if (section < NumSections)
+            std::copy(newSectionCoeffs.begin(), newSectionCoeffs.end(), coeffs.begin() + (section * CoeffsPerSection));
+    }
+
+    // Process audio
+    // This method can be called with a lower number of channels than allocated
+    void process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+    {
+        numChannels = std::min(numChannels, MaxChannels);
+        for (unsigned int c0 = 0; c0 < numChannels; c0 += Simd::Lanes)
+        {
+            const unsigned int numLanes { std::min(numChannels - c0, Simd::Lanes) };
+            const unsigned int endIdleChannel { std::min(c0 + Simd::Lanes, MaxChannels) };
+
+            std::array<float, IdleStatesSize> idleStates;
+            saveIdleStates(idleStates, c0 + numLanes, endIdleChannel);
+
+            for (unsigned int n = 0; n < numSamples; ++n)
+            {
+                float frame[Simd::Lanes] { 0.f, 0.f, 0.f, 0.f };
+                for (unsigned int l = 0; l < numLanes; ++l)
+                    frame[l] = input[c0 + l][n];
+
+                Simd::Float4 x { Simd::Float4::load(frame) };
+                processSections(x, c0, std::make_integer_sequence<unsigned int, NumSections> {});
+                x.store(frame);
+
+                for (unsigned int l = 0; l < numLanes; ++l)
+                    output[c0 + l][n] = frame[l];
+            }
+
+            restoreIdleStates(idleStates, c0 + numLanes, endIdleChannel);
+        }
+    }
+
+    // Process audio
+    // Single sample flavour
+    void process(float* output, const float* input, unsigned int numChannels)
+    {
+        numChannels = std::min(numChannels, MaxChannels);
+        for (unsigned int c0 = 0; c0 < numChannels; c0 += Simd::Lanes)
+        {
+            const unsigned int numLanes { std::min(numChannels - c0, Simd::Lanes) };
+            const unsigned int endIdleChannel { std::min(c0 + Simd::Lanes, MaxChannels) };
+
+            std::array<float, IdleStatesSize> idleStates;
+            saveIdleStates(idleStates, c0 + numLanes, endIdleChannel);
+
+            float frame[Simd::Lanes] { 0.f, 0.f, 0.f, 0.f };
+            for (unsigned int l = 0; l < numLanes; ++l)
+                frame[l] = input[c0 + l];
+
+            Simd::Float4 x { Simd::Float4::load(frame) };
+            processSections(x, c0, std::make_integer_sequence<unsigned int, NumSections> {});
+            x.store(frame);
+
+            for (unsigned int l = 0; l < numLanes; ++l)
+                output[c0 + l] = frame[l];
+
+            restoreIdleStates(idleStates, c0 + numLanes, endIdleChannel);
+        }
+    }
+
+    static constexpr unsigned int getAllocatedChannels() noexcept { return MaxChannels; }
+    static constexpr unsigned int getAllocatedSections() noexcept { return NumSections; }
+
+private:
+    static constexpr unsigned int PaddedChannels { (MaxChannels + Simd::Lanes - 1u) / Simd::Lanes * Simd::Lanes };
+    static constexpr unsigned int IdleStatesSize { NumSections * StatesPerSection * Simd::Lanes };
+
+    // [sos0_b0, sos0_b1, sos0_b2, sos0_a1, sos0_a2, sos1_b0, sos1_b1, ...]
+    alignas(Simd::Alignment) std::array<float, NumSections * CoeffsPerSection> coeffs;
+
+    // [sos0_bz1_ch0, sos0_bz1_ch1, ... , sos0_bz2_ch0, ... , sos0_az2_chN, sos1_bz1_ch0, ...]
+    alignas(Simd::Alignment) std::array<float, NumSections * StatesPerSection * PaddedChannels> states;
+
+    template<unsigned int... Sections>
+    void processSections(Simd::Float4& x, unsigned int channelOffset, std::integer_sequence<unsigned int, Sections...>)
+    {
+        (processSection<Sections>(x, channelOffset), ...);
+    }
+
+    template<unsigned int Section>
+    void processSection(Simd::Float4& x, unsigned int channelOffset)
+    {
+        constexpr unsigned int stateOffset { Section * StatesPerSection * PaddedChannels };
+        constexpr unsigned int coeffOffset { Section * CoeffsPerSection };
+
+        float* bz1 { states.data() + stateOffset + channelOffset };
+        float* bz2 { bz1 + PaddedChannels };
+        float* az1 { bz2 + PaddedChannels };
+        float* az2 { az1 + PaddedChannels };
+
+        const Simd::Float4 xz1 { Simd::Float4::load(bz1) };
+        const Simd::Float4 yz1 { Simd::Float4::load(az1) };
+
+        Simd::Float4 acc { x * Simd::Float4::broadcast(coeffs[coeffOffset + 0]) }; // b0
+        acc = acc + Simd::Float4::broadcast(coeffs[coeffOffset + 1]) * xz1; // b1
+        acc = acc + Simd::Float4::broadcast(coeffs[coeffOffset + 2]) * Simd::Float4::load(bz2); // b2
+        acc = acc - Simd::Float4::broadcast(coeffs[coeffOffset + 3]) * yz1; // a1
+        acc = acc - Simd::Float4::broadcast(coeffs[coeffOffset + 4]) * Simd::Float4::load(az2); // a2
+
+        xz1.store(bz2);
+        x.store(bz1);
+        yz1.store(az2);
+        acc.store(az1);
+        x = acc;
+    }
+
+    void saveIdleStates(std::array<float, IdleStatesSize>& idleStates, unsigned int firstIdleChannel, unsigned int endIdleChannel) const
+    {
+        for (unsigned int i = 0; i < NumSections * StatesPerSection; ++i)
+            for (unsigned int c = firstIdleChannel; c < endIdleChannel; ++c)
+                idleStates[i * Simd::Lanes + c % Simd::Lanes] = states[i * PaddedChannels + c];
+    }
+
+    void restoreIdleStates(const std::array<float, IdleStatesSize>& idleStates, unsigned int firstIdleChannel, unsigned int endIdleChannel)
+    {
+        for (unsigned int i = 0; i < NumSections * StatesPerSection; ++i)
+            for (unsigned int c = firstIdleChannel; c < endIdleChannel; ++c)
+                states[i * PaddedChannels + c] = idleStates[i * Simd::Lanes + c % Simd::Lanes];
+    }
+};
+
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "FixedBiquad.h"
+#include "ParametricEqualizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace DSP
+{
+
+// Parametric equalizer with the number of bands and channels known at compile time
+// Same band controls and batch coefficient design as ParametricEqualizer,
+// but realized with a FixedBiquad so it never touches the heap
+template<unsigned int NumBands, unsigned int MaxChannels>
+class FixedParametricEqualizer
+{
+public:
+    using FilterType = ParametricEqualizer::FilterType;
+    using Band = ParametricEqualizer::Band;
+
+    // All bands filters will be initialised to Flat
+    FixedParametricEqualizer()
+    {
+        updateAllCoeffs();
+    }
+
+    ~FixedParametricEqualizer() { }
+
+    // No copy sematics
+    FixedParametricEqualizer(const FixedParametricEqualizer&) = delete;
+    const FixedParametricEqualizer& operator=(const FixedParametricEqualizer&) = delete;
+
+    // No move semantics
+    FixedParametricEqualizer(FixedParametricEqualizer&&) = delete;
+    const FixedParametricEqualizer& operator=(FixedParametricEqualizer&&) = delete;
+
+    // Clear states
+    void clear()
+    {
+        biquad.clear();
+    }
+
+    // Clear states and recalculate coeffs to new sample rate
+    void prepare(double newSampleRate)
+    {
+        sampleRate = std::fmax(newSampleRate, 1.f);
+        updateAllCoeffs();
+        biquad.clear();
+    }
+
+    // Process audio buffers
+    // This method can be called with a lower number of channels than allocated
+    void process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+    {
+        biquad.process(output, input, numChannels, numSamples);
+    }
+
+    // Process audio buffers
+    // Single sample flavour
+    void process(float* output, const float* input, unsigned int numChannels)
+    {
+        biquad.process(output, input, numChannels);
+    }
+
+    // Set filter type of a band
+    void setBandType(unsigned int band, FilterType type)
+    {
+        if (band < NumBands)
+        {
+            bands[band].type = type;
+            updateBandCoeffs(band);
+        }
+    }
+
+    // Set filter frequency of a band in Hz
+    void setBandFrequency(unsigned int band, float frequency)
+    {
+        if (band < NumBands)
+        {
+            bands[band].freq = std::fmax(frequency, 2.f);
+            updateBandCoeffs(band);
+        }
+    }
+
+    // Set filter resonance of a band in Q factor
+    void setBandResonance(unsigned int band, float resonance)
+    {
+        if (band < NumBands)
+        {
+            bands[band].reso = std::fmax(resonance, 0.1f);
+            updateBandCoeffs(band);
+        }
+    }
+
+    // Set filter gain of a band in dB
+    void setBandGain(unsigned int band, float gain)
+    {
+        if (band < NumBands)
+        {
+            bands[band].gain = gain;
+            updateBandCoeffs(band);
+        }
+    }
+
+private:
+    // Biquad structure for filter realization
+    DSP::FixedBiquad<NumBands, MaxChannels> biquad;
+
+    // Current sample rate of coefficients
+    double sampleRate { 48000.0 };
+
+    // All bands information
+    std::array<Band, NumBands> bands;
+
+    void updateBandCoeffs(unsigned int band)
+    {
+        std::array<float, Biquad::CoeffsPerSection> coeffs;
+        ParametricEqualizer::calculateCoeffs(&bands[band], 1, sampleRate, coeffs.data());
+        biquad.setSectionCoeffs(coeffs, band);
+    }
+
+    void updateAllCoeffs()
+    {
+        std::array<float, NumBands * Biquad::CoeffsPerSection> coeffs;
+        ParametricEqualizer::calculateCoeffs(bands.data(), NumBands, sampleRate, coeffs.data());
+
+        for (unsigned int b = 0; b < NumBands; ++b)
+        {
+            std::array<float, Biquad::CoeffsPerSection> sectionCoeffs;
+            std::copy_n(coeffs.begin() + b * Biquad::CoeffsPerSection, Biquad::CoeffsPerSection, sectionCoeffs.begin());
+            biquad.setSectionCoeffs(sectionCoeffs, b);
+        }
+    }
+};
+
+}
@@ -1,5 +1,6 @@
 #include "Flanger.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace DSP
@@ -8,8 +9,10 @@ namespace DSP
 Flanger::Flanger(float maxTimeMs, unsigned int numChannels) :
     delayLine(static_cast<unsigned int>(std::ceil(std::fmax(maxTimeMs, 1.f) * static_cast<float>(0.001 * sampleRate))), numChannels),
     offsetRamp(0.05f),
-    modDepthRamp(0.05f)
+    modDepthRamp(0.05f),
+    lfo(MaxChannels)
 {
+    lfo.setPhaseOffset(1, 0.25f);
 }
 
 Flanger::~Flanger()
@@ -26,9 +29,7 @@ void Flanger::prepare(double newSampleRate, float maxTimeMs, unsigned int numCha
     offsetRamp.prepare(sampleRate, true, offsetMs * static_cast<float>(0.001 * sampleRate));
     modDepthRamp.prepare(sampleRate, true, modDepthMs * static_cast<float>(0.001 * sampleRate));
 
-    phaseState[0] = 0.f;
-    phaseState[1] = static_cast<float>(M_PI / 2.0);
-    phaseInc = static_cast<float>(2.0 * M_PI / sampleRate) * modRate;
+    lfo.prepare(sampleRate);
 }
 
 void Flanger::clear()
@@ -38,44 +39,30 @@ void Flanger::clear()
 
 void Flanger::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
 {
-    for (unsigned int n = 0; n < numSamples; ++n)
-    {
-        // Process LFO acording to mod type
-        float lfo[2] { 0.f, 0.f };
-        switch (modType)
-        {
-        case Tri:
-            lfo[0] = std::fabs((phaseState[0] - static_cast<float>(M_PI)) / static_cast<float>(M_PI));
-            lfo[1] = std::fabs((phaseState[1] - static_cast<float>(M_PI)) / static_cast<float>(M_PI));
-            break;
-
-        case Sin:
-            lfo[0] = 0.5f + 0.5f * std::sin(phaseState[0]);
-            lfo[1] = 0.5f + 0.5f * std::sin(phaseState[1]);
-            break;
-        }
+    numChannels = std::min(numChannels, static_cast<unsigned int>(MaxChannels));
 
-        // Increment and wrap phase states
-        phaseState[0] = std::fmod(phaseState[0] + phaseInc, static_cast<float>(2 * M_PI));
-        phaseState[1] = std::fmod(phaseState[1] + phaseInc, static_cast<float>(2 * M_PI));
+    float modBuffer[MaxChannels][ChunkSize];
+    float* mod[MaxChannels] { modBuffer[0], modBuffer[1] };
 
-        // Apply mod depth and offset ramps
-        modDepthRamp.applyGain(lfo, numChannels);
-        offsetRamp.applySum(lfo, numChannels);
-
-        // Delay in/out
-        float x[2];
-        float y[2];
+    for (unsigned int n = 0; n < numSamples; n += ChunkSize)
+    {
+        const unsigned int chunkSamples { std::min(numSamples - n, ChunkSize) };
 
-        for (unsigned int ch = 0; ch < numChannels; ++ch)
-            x[ch] = input[ch][n];
+        // LFO scaled by the mod depth ramp on top of the offset ramp
+        generateModulation(mod, numChannels, chunkSamples);
+        modDepthRamp.applyGain(mod, numChannels, chunkSamples);
+        offsetRamp.applySum(mod, numChannels, chunkSamples);
 
         // Process delay
-        delayLine.process(y, x, lfo, numChannels);
-
-        // Write to output buffers
+        const float* x[MaxChannels];
+        float* y[MaxChannels];
         for (unsigned int ch = 0; ch < numChannels; ++ch)
-            output[ch][n] = y[ch];
+        {
+            x[ch] = input[ch] + n;
+            y[ch] = output[ch] + n;
+        }
+
+        delayLine.process(y, x, mod, numChannels, chunkSamples);
     }
 }
 
@@ -96,12 +83,37 @@ void Flanger::setDepth(float newDepthMs)
 void Flanger::setModulationRate(float newModRateHz)
 {
     modRate = std::fmax(newModRateHz, 0.f);
-    phaseInc = static_cast<float>(2.0 * M_PI / sampleRate) * modRate;
+    lfo.setFrequency(modRate);
 }
 
 void Flanger::setModulationType(ModulationType newModType)
 {
     modType = newModType;
+    lfo.setWaveform(modType == Tri ? Lfo::Tri : Lfo::Sin);
+}
+
+void Flanger::setInterpolation(DelayLine::Interpolation newInterpolation)
+{
+    delayLine.setInterpolation(newInterpolation);
+}
+
+void Flanger::generateModulation(float* const* mod, unsigned int numChannels, unsigned int numSamples)
+{
+    using Simd::Float4;
+
+    lfo.process(mod, numChannels, numSamples);
+
+    // Bipolar to unipolar, whole groups of Simd::Lanes then the samples past the last one
+    const unsigned int vectorSamples { numSamples / Simd::Lanes * Simd::Lanes };
+    const Float4 half { Float4::broadcast(0.5f) };
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        for (unsigned int n = 0; n < vectorSamples; n += Simd::Lanes)
+            (half + half * Float4::load(mod[ch] + n)).store(mod[ch] + n);
+
+        for (unsigned int n = vectorSamples; n < numSamples; ++n)
+            mod[ch][n] = 0.5f + 0.5f * mod[ch][n];
+    }
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include "Lfo.h"
+#include "Phase.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DSP
+{
+
+namespace
+{
+    // Radians per phase step
+    constexpr double RadiansPerStep { 2.0 * M_PI / Phase::StepsPerCycle };
+
+    float tri(std::uint32_t phase)
+    {
+        return 2.f * std::fabs(Phase::bipolar(phase)) - 1.f;
+    }
+
+    float sqr(std::uint32_t phase)
+    {
+        return phase < 0x80000000u ? -1.f : 1.f;
+    }
+
+    // Every sample from the start phase, the accumulator wraps by itself
+    template <float (*shapeOf)(std::uint32_t)>
+    void renderShape(float* output, std::uint32_t phase, std::uint32_t phaseInc, unsigned int numSamples)
+    {
+        for (unsigned int n = 0; n < numSamples; ++n)
+            output[n] = shapeOf(phase + phaseInc * n);
+    }
+}
+
+Lfo::Lfo(unsigned int numChannels) :
+    phaseOffsets(std::max(numChannels, 1u), 0u),
+    cache(std::max(numChannels, 1u) * ChunkSize, 0.f),
+    cacheRows(std::max(numChannels, 1u), nullptr)
+{
+    for (unsigned int ch = 0; ch < getNumChannels(); ++ch)
+        cacheRows[ch] = cache.data() + ch * ChunkSize;
+
+    updateIncrement();
+}
+
+Lfo::~Lfo()
+{
+}
+
+void Lfo::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    updateIncrement();
+    reset();
+}
+
+void Lfo::reset()
+{
+    phase = 0;
+    cacheIndex = ChunkSize;
+}
+
+void Lfo::process(float* const* output, unsigned int numChannels, unsigned int numSamples)
+{
+    render(output, numChannels, phase, numSamples);
+    phase += phaseInc * numSamples;
+
+    // The single sample chunk did not follow
+    cacheIndex = ChunkSize;
+}
+
+void Lfo::process(float* output, unsigned int numChannels)
+{
+    numChannels = std::min(numChannels, getNumChannels());
+
+    if (cacheIndex == ChunkSize)
+    {
+        render(cacheRows.data(), getNumChannels(), phase, ChunkSize);
+        cacheIndex = 0;
+    }
+
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        output[ch] = cache[ch * ChunkSize + cacheIndex];
+
+    ++cacheIndex;
+    phase += phaseInc;
+}
+
+void Lfo::setFrequency(float newFrequencyHz)
+{
+    frequency = std::fmax(newFrequencyHz, 0.f);
+    updateIncrement();
+}
+
+void Lfo::setWaveform(Waveform newWaveform)
+{
+    waveform = newWaveform > Saw ? Saw : newWaveform;
+    cacheIndex = ChunkSize;
+}
+
+void Lfo::setPhaseOffset(unsigned int channel, float offsetCycles)
+{
+    if (channel < getNumChannels())
+    {
+        phaseOffsets[channel] = Phase::fromCycles(offsetCycles);
+        cacheIndex = ChunkSize;
+    }
+}
+
+void Lfo::updateIncrement()
+{
+    // Below Nyquist, the increment is the exact frequency of the accumulator
+    phaseInc = Phase::increment(frequency, sampleRate);
+
+    const double omega { RadiansPerStep * phaseInc };
+    cosInc = static_cast<float>(std::cos(omega));
+    sinInc = static_cast<float>(std::sin(omega));
+    cosStep = static_cast<float>(std::cos(Simd::Lanes * omega));
+    sinStep = static_cast<float>(std::sin(Simd::Lanes * omega));
+
+    cacheIndex = ChunkSize;
+}
+
+void Lfo::render(float* const* output, unsigned int numChannels, std::uint32_t startPhase, unsigned int numSamples) const
+{
+    numChannels = std::min(numChannels, getNumChannels());
+
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        const std::uint32_t channelPhase { startPhase + phaseOffsets[ch] };
+        float* y { output[ch] };
+
+        switch (waveform)
+        {
+        case Sin:
+            for (unsigned int n = 0; n < numSamples; n += ChunkSize)
+                renderSin(y + n, channelPhase + phaseInc * n, std::min(numSamples - n, ChunkSize));
+            break;
+
+        case Tri:
+            renderShape<tri>(y, channelPhase, phaseInc, numSamples);
+            break;
+
+        case Sqr:
+            renderShape<sqr>(y, channelPhase, phaseInc, numSamples);
+            break;
+
+        case Saw:
+            renderShape<Phase::bipolar>(y, channelPhase, phaseInc, numSamples);
+            break;
+        }
+    }
+}
+
+void Lfo::renderSin(float* output, std::uint32_t startPhase, unsigned int numSamples) const
+{
+    using Simd::Float4;
+
+    // Lanes hold four consecutive samples of the sine and cosine, seeded from the exact phase
+    // and advanced by rotating them Simd::Lanes increments at a time
+    const double angle { RadiansPerStep * startPhase };
+    float s[Simd::Lanes] { static_cast<float>(std::sin(angle)) };
+    float c[Simd::Lanes] { static_cast<float>(std::cos(angle)) };
+    for (unsigned int l = 1; l < Simd::Lanes; ++l)
+    {
+        s[l] = s[l - 1] * cosInc + c[l - 1] * sinInc;
+        c[l] = c[l - 1] * cosInc - s[l - 1] * sinInc;
+    }
+
+    const Float4 cosLanesStep { Float4::broadcast(cosStep) };
+    const Float4 sinLanesStep { Float4::broadcast(sinStep) };
+    Float4 sinLanes { Float4::load(s) };
+    Float4 cosLanes { Float4::load(c) };
+
+    // Scratch holds a multiple of Simd::Lanes samples
+    float sine[ChunkSize];
+    for (unsigned int n = 0; n < numSamples; n += Simd::Lanes)
+    {
+        sinLanes.store(sine + n);
+
+        const Float4 nextSin { sinLanes * cosLanesStep + cosLanes * sinLanesStep };
+        cosLanes = cosLanes * cosLanesStep - sinLanes * sinLanesStep;
+        sinLanes = nextSin;
+    }
+
+    std::copy(sine, sine + numSamples, output);
+}
+
+}
\ No newline at end of file
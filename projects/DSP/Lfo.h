@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace DSP
+{
+
+// Low frequency oscillator rendering blocks of several phase offset channels
+// The phase is a 32 bit integer accumulator that wraps by itself, so it needs no fmod
+// and does not lose precision at long uptimes
+// Sin rotates a complex phasor, Simd::Lanes samples at a time, and re-seeds it from the
+// exact phase every ChunkSize samples, so its amplitude and phase errors cannot build up
+// Tri, Sqr and Saw are calculated from the phase accumulator directly
+// The single sample flavour hands out a rendered chunk, so both flavours output the same
+class Lfo
+{
+public:
+    // Waveforms, all bipolar from -1 to 1
+    //  - Sin: starts at 0 rising
+    //  - Tri: starts at 1 and reaches -1 at half the cycle
+    //  - Sqr: -1 for the first half of the cycle and 1 for the second
+    //  - Saw: rises from -1 to 1
+    enum Waveform : unsigned int
+    {
+        Sin = 0,
+        Tri,
+        Sqr,
+        Saw
+    };
+
+    // Main ctor
+    // Requires the number of channels, all start without phase offset
+    Lfo(unsigned int numChannels);
+
+    // Dtor
+    ~Lfo();
+
+    // No default ctor
+    Lfo() = delete;
+
+    // No copy semantics
+    Lfo(const Lfo&) = delete;
+    const Lfo& operator=(const Lfo&) = delete;
+
+    // No move semantics
+    Lfo(Lfo&&) = delete;
+    const Lfo& operator=(Lfo&&) = delete;
+
+    // Update sample rate and restart all channels at their phase offsets
+    void prepare(double sampleRate);
+
+    // Restart all channels at their phase offsets
+    void reset();
+
+    // Render a block of every channel
+    void process(float* const* output, unsigned int numChannels, unsigned int numSamples);
+
+    // Single sample flavour
+    void process(float* output, unsigned int numChannels);
+
+    // Set the frequency in Hz
+    void setFrequency(float newFrequencyHz);
+
+    // Set the waveform of all channels
+    void setWaveform(Waveform newWaveform);
+
+    // Set the phase offset of a channel in cycles, e.g. 0.25 for a quadrature channel
+    void setPhaseOffset(unsigned int channel, float offsetCycles);
+
+    // return the frequency in Hz
+    float getFrequency() const noexcept { return frequency; }
+
+    // return the waveform
+    Waveform getWaveform() const noexcept { return waveform; }
+
+    // return the number of channels
+    unsigned int getNumChannels() const noexcept { return static_cast<unsigned int>(phaseOffsets.size()); }
+
+private:
+    // Samples rendered per seed of the sine phasor
+    static constexpr unsigned int ChunkSize { 64 };
+
+    double sampleRate { 48000.0 };
+    float frequency { 1.f };
+    Waveform waveform { Sin };
+
+    // Phase without offset and its increment per sample, a full cycle is 2^32
+    std::uint32_t phase { 0 };
+    std::uint32_t phaseInc { 0 };
+    std::vector<std::uint32_t> phaseOffsets;
+
+    // Rotation of the phasor by one and by Simd::Lanes increments
+    float cosInc { 1.f };
+    float sinInc { 0.f };
+    float cosStep { 1.f };
+    float sinStep { 0.f };
+
+    // Chunk of every channel for the single sample flavour, one row of ChunkSize samples
+    // per channel, rendered from the phase when cacheIndex reaches ChunkSize
+    std::vector<float> cache;
+    std::vector<float*> cacheRows;
+    unsigned int cacheIndex { ChunkSize };
+
+    // Recalculate the phase increment and rotations for the frequency and sample rate
+    void updateIncrement();
+
+    // Render a block of every channel from a phase without advancing it
+    void render(float* const* output, unsigned int numChannels, std::uint32_t startPhase, unsigned int numSamples) const;
+
+    // Render up to ChunkSize samples of the sine from a phase
+    void renderSin(float* output, std::uint32_t startPhase, unsigned int numSamples) const;
+};
+
+}
\ No newline at end of file
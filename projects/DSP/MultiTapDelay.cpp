@@ -0,0 +1,183 @@
+#include "MultiTapDelay.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DSP
+{
+
+MultiTapDelay::MultiTapDelay(unsigned int maxLengthSamples, unsigned int numOfTaps) :
+    delayLine(std::max(maxLengthSamples, 1u) + ChunkSize, 1),
+    maxLength { std::max(maxLengthSamples, 1u) },
+    tapDelays(numOfTaps, 1.f),
+    tapGains(numOfTaps, 1.f),
+    tapPans(numOfTaps, 0.f),
+    tapGainsLeft(numOfTaps, 0.f),
+    tapGainsRight(numOfTaps, 0.f)
+{
+    for (unsigned int tap = 0; tap < numOfTaps; ++tap)
+        setTapPan(tap, 0.f);
+}
+
+MultiTapDelay::~MultiTapDelay()
+{
+}
+
+void MultiTapDelay::clear()
+{
+    delayLine.clear();
+}
+
+void MultiTapDelay::prepare(unsigned int maxLengthSamples)
+{
+    maxLength = std::max(maxLengthSamples, 1u);
+    delayLine.prepare(maxLength + ChunkSize, 1);
+
+    for (unsigned int tap = 0; tap < getNumTaps(); ++tap)
+        setTapDelay(tap, tapDelays[tap]);
+}
+
+void MultiTapDelay::process(float* const* output, const float* const* input, unsigned int numInputs, unsigned int numOutputs, unsigned int numSamples)
+{
+    process(output, input, nullptr, numInputs, numOutputs, numSamples);
+}
+
+void MultiTapDelay::process(float* const* output, const float* const* input, const float* const* tapMod,
+                            unsigned int numInputs, unsigned int numOutputs, unsigned int numSamples)
+{
+    using Simd::Float4;
+
+    numOutputs = std::min(numOutputs, MaxOutputs);
+    const float inputScale { numInputs > 0 ? 1.f / static_cast<float>(numInputs) : 0.f };
+
+    for (unsigned int n = 0; n < numSamples; n += ChunkSize)
+    {
+        const unsigned int chunkSamples { std::min(numSamples - n, ChunkSize) };
+
+        // Mix the input to mono and write it once for all taps
+        float mono[ChunkSize] {};
+        for (unsigned int ch = 0; ch < numInputs; ++ch)
+            for (unsigned int k = 0; k < chunkSamples; ++k)
+                mono[k] += input[ch][n + k];
+
+        for (unsigned int k = 0; k < chunkSamples; ++k)
+            mono[k] *= inputScale;
+
+        const unsigned int startIndex { delayLine.getWriteIndex() };
+        const float* monoInput { mono };
+        delayLine.write(&monoInput, 1, chunkSamples);
+
+        // Sum all taps with their gains, the chunk buffers are a multiple of Simd::Lanes
+        float sum[MaxOutputs][ChunkSize] {};
+        float y[ChunkSize] {};
+        for (unsigned int tap = 0; tap < getNumTaps(); ++tap)
+        {
+            const float* mod { tapMod != nullptr && tapMod[tap] != nullptr ? tapMod[tap] + n : nullptr };
+            readTap(tap, mod, startIndex, chunkSamples, y);
+
+            for (unsigned int out = 0; out < numOutputs; ++out)
+            {
+                const float gain { numOutputs == 1 ? tapGains[tap] : out == 0 ? tapGainsLeft[tap] : tapGainsRight[tap] };
+                if (gain == 0.f)
+                    continue;
+
+                const Float4 g { Float4::broadcast(gain) };
+                for (unsigned int k = 0; k < chunkSamples; k += Simd::Lanes)
+                    (Float4::load(sum[out] + k) + g * Float4::load(y + k)).store(sum[out] + k);
+            }
+        }
+
+        for (unsigned int out = 0; out < numOutputs; ++out)
+            std::copy(sum[out], sum[out] + chunkSamples, output[out] + n);
+    }
+}
+
+void MultiTapDelay::setTapDelay(unsigned int tap, float delaySamples)
+{
+    if (tap < getNumTaps())
+        tapDelays[tap] = std::fmin(std::fmax(delaySamples, 0.f), static_cast<float>(maxLength - 1u));
+}
+
+void MultiTapDelay::setTapGain(unsigned int tap, float gain)
+{
+    if (tap < getNumTaps())
+    {
+        tapGains[tap] = gain;
+        setTapPan(tap, tapPans[tap]);
+    }
+}
+
+void MultiTapDelay::setTapPan(unsigned int tap, float pan)
+{
+    if (tap < getNumTaps())
+    {
+        tapPans[tap] = std::fmin(std::fmax(pan, -1.f), 1.f);
+        const float angle { (tapPans[tap] + 1.f) * static_cast<float>(M_PI / 4.0) };
+        tapGainsLeft[tap] = tapGains[tap] * std::cos(angle);
+        tapGainsRight[tap] = tapGains[tap] * std::sin(angle);
+    }
+}
+
+void MultiTapDelay::readTap(unsigned int tap, const float* mod, unsigned int startIndex, unsigned int numSamples, float* y) const
+{
+    using Simd::Float4;
+
+    const float* buffer { delayLine.getChannelData(0) };
+    const unsigned int bufferSize { delayLine.getBufferSize() };
+    const unsigned int bufferMask { bufferSize - 1u };
+    const float delay { tapDelays[tap] };
+
+    // Sample n of the chunk was written at startIndex + n, the tap reads the newer sample x0
+    // delay samples before it and the older x1 right before x0, the guard keeps both contiguous
+    if (mod == nullptr)
+    {
+        const float delayFloor { std::floor(delay) };
+        const Float4 t1 { Float4::broadcast(delay - delayFloor) };
+        const Float4 t0 { Float4::broadcast(1.f) - t1 };
+
+        // A fixed delay reads runs of consecutive samples, split where the buffer wraps
+        unsigned int olderIndex { (startIndex - static_cast<unsigned int>(delayFloor) - 1u) & bufferMask };
+        for (unsigned int n = 0; n < numSamples;)
+        {
+            const unsigned int length { std::min(numSamples - n, bufferSize - olderIndex) };
+            const float* x1 { buffer + olderIndex };
+
+            unsigned int k { 0 };
+            for (; k + Simd::Lanes <= length; k += Simd::Lanes)
+                (Float4::load(x1 + k + 1u) * t0 + Float4::load(x1 + k) * t1).store(y + n + k);
+
+            for (; k < length; ++k)
+                y[n + k] = x1[k + 1u] * (1.f - (delay - delayFloor)) + x1[k] * (delay - delayFloor);
+
+            olderIndex = (olderIndex + length) & bufferMask;
+            n += length;
+        }
+    }
+    else
+    {
+        const float maxDelay { static_cast<float>(maxLength - 1u) };
+
+        for (unsigned int n = 0; n < numSamples; n += Simd::Lanes)
+        {
+            // Chunk scratch is a multiple of Simd::Lanes, lanes past the end read a valid index
+            const float* x1[Simd::Lanes];
+            float t[Simd::Lanes];
+            for (unsigned int l = 0; l < Simd::Lanes; ++l)
+            {
+                const float m { n + l < numSamples ? mod[n + l] : 0.f };
+                const float d { std::fmin(std::fmax(delay + m, 0.f), maxDelay) };
+                const float dFloor { std::floor(d) };
+                t[l] = d - dFloor;
+                x1[l] = buffer + ((startIndex + n + l - static_cast<unsigned int>(dFloor) - 1u) & bufferMask);
+            }
+
+            const Float4 t1 { Float4::load(t) };
+            const Float4 older { Float4::set(x1[0][0], x1[1][0], x1[2][0], x1[3][0]) };
+            const Float4 newer { Float4::set(x1[0][1], x1[1][1], x1[2][1], x1[3][1]) };
+            (newer * (Float4::broadcast(1.f) - t1) + older * t1).store(y + n);
+        }
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "DelayLine.h"
+
+#include <vector>
+
+namespace DSP
+{
+
+// Multi-tap delay, e.g. for tapped echoes or a chorus ensemble
+// The input is mixed to mono and written once to a DelayLine, every tap reads it back
+// with its own delay time, gain, pan and optional audio rate modulation
+// Taps run one after the other over chunks of ChunkSize samples that stay in cache,
+// each tap vectorized over the samples of the chunk
+class MultiTapDelay
+{
+public:
+    // Maximum number of output channels, taps are panned across a stereo output
+    static constexpr unsigned int MaxOutputs { 2 };
+
+    // Main ctor
+    // Requires the maximum delay time in samples and the number of taps
+    // The number of taps cannot be modified later
+    // All taps are initialised to 1 sample delay, unity gain and centre pan
+    MultiTapDelay(unsigned int maxLengthSamples, unsigned int numOfTaps);
+
+    // Dtor
+    ~MultiTapDelay();
+
+    // No default ctor
+    MultiTapDelay() = delete;
+
+    // No copy semantics
+    MultiTapDelay(const MultiTapDelay&) = delete;
+    const MultiTapDelay& operator=(const MultiTapDelay&) = delete;
+
+    // No move semantics
+    MultiTapDelay(MultiTapDelay&&) = delete;
+    const MultiTapDelay& operator=(MultiTapDelay&&) = delete;
+
+    // Clear the contents of the delay buffer
+    void clear();
+
+    // Resize the delay buffer for the new maximum delay time and clear its contents
+    void prepare(unsigned int maxLengthSamples);
+
+    // Process audio, the input channels are mixed to mono
+    // A mono output takes the sum of all taps without panning
+    void process(float* const* output, const float* const* input, unsigned int numInputs, unsigned int numOutputs, unsigned int numSamples);
+
+    // Process audio with audio rate modulation of the taps
+    // tapMod[tap] holds the modulation in samples added to the tap delay time,
+    // or is null for a tap without modulation
+    void process(float* const* output, const float* const* input, const float* const* tapMod,
+                 unsigned int numInputs, unsigned int numOutputs, unsigned int numSamples);
+
+    // Tap changes are not smoothed and take effect at the next process call
+
+    // Set the delay time of a tap in samples, fractional times are linearly interpolated
+    // A delay of 0 reads the input sample being written
+    void setTapDelay(unsigned int tap, float delaySamples);
+
+    // Set the linear gain of a tap
+    void setTapGain(unsigned int tap, float gain);
+
+    // Set the pan of a tap from -1 (left) to 1 (right), constant power
+    void setTapPan(unsigned int tap, float pan);
+
+    // return the number of taps
+    unsigned int getNumTaps() const noexcept { return static_cast<unsigned int>(tapDelays.size()); }
+
+private:
+    static constexpr unsigned int ChunkSize { 64 };
+
+    // Mono history of the input, longer than the maximum delay by a chunk
+    // since every chunk is written before its taps are read
+    DelayLine delayLine;
+    unsigned int maxLength { 0 };
+
+    // Tap settings and their panned gains
+    std::vector<float> tapDelays;
+    std::vector<float> tapGains;
+    std::vector<float> tapPans;
+    std::vector<float> tapGainsLeft;
+    std::vector<float> tapGainsRight;
+
+    // Read a tap without its gain over a chunk written from startIndex
+    void readTap(unsigned int tap, const float* mod, unsigned int startIndex, unsigned int numSamples, float* y) const;
+};
+
+}
\ No newline at end of file
@@ -1,10 +1,48 @@
 #include "Oscillator.h"
+#include "FastMath.h"
+#include "Phase.h"
+#include "Simd.h"
+
 #include <algorithm>
 #include <cmath>
 
 namespace DSP
 {
 
+namespace
+{
+    // Sign of a bipolar phase, the half step bias only moves 0 to the positive side as copysign would
+    Simd::Float4 sign(const Simd::Float4& bipolar)
+    {
+        using Simd::Float4;
+
+        const Float4 one { Float4::broadcast(1.f) };
+        return Simd::min(Simd::max((bipolar + Float4::broadcast(0.5f * Phase::BipolarStep)) * Float4::broadcast(1099511627776.f), Float4::broadcast(0.f) - one), one);
+    }
+
+    // Residual weights of the samples around the step at the start of the cycle of a bipolar phase,
+    // 1 minus the samples since the step and 1 minus the samples until the next one, clipped at 0
+    // Only the sample right after and the one right before the step get a weight
+    void stepWeights(const Simd::Float4& bipolar, const Simd::Float4& halfSamplesPerCycle, Simd::Float4& after, Simd::Float4& before)
+    {
+        using Simd::Float4;
+
+        const Float4 zero { Float4::broadcast(0.f) };
+        const Float4 one { Float4::broadcast(1.f) };
+        after = Simd::max(one - (bipolar + one) * halfSamplesPerCycle, zero);
+        before = Simd::max(one - (one - bipolar) * halfSamplesPerCycle, zero);
+    }
+
+    // Saw from -1 to 1 with the PolyBLEP residual of its falling step
+    Simd::Float4 polyBlepSaw(const Simd::Float4& bipolar, const Simd::Float4& halfSamplesPerCycle)
+    {
+        Simd::Float4 after;
+        Simd::Float4 before;
+        stepWeights(bipolar, halfSamplesPerCycle, after, before);
+        return bipolar + after * after - before * before;
+    }
+}
+
 Oscillator::Oscillator()
 {
 }
@@ -18,88 +56,69 @@ void Oscillator::prepare(double newSampleRate)
     sampleRate = newSampleRate;
 
     // update phase increment for new sample rate
-    phaseInc = static_cast<float>(1.0 / sampleRate) * frequency;
-
-    differentiatorCoeff = static_cast<float>(sampleRate) / (4.f * frequency * (1.f - frequency / static_cast<float>(sampleRate)));
+    updateIncrement();
 
     // reset states
-    phaseState = 0.f;
+    phaseState = 0;
     differentiatorState = 0.f;
 }
 
 void Oscillator::process(float* output, unsigned int numSamples)
 {
-    for (unsigned int n = 0; n < numSamples; ++n)
-    {
-        switch (type)
-        {
-        case Sin:
-            output[n] = std::sin(static_cast<float>(2.0 * M_PI) * phaseState);
-            break;
-
-        case TriAliased:
-            output[n] = 4.f * std::fabs(phaseState - 0.5f) - 1.f;
-            break;
-
-        case SawAliased:
-            output[n] = 2.f * phaseState - 1.f;
-            break;
-
-        case TriAA:
-            output[n] = dpwTri();
-            break;
-
-        case SawAA:
-            output[n] = dpwSaw();
-            break;
-
-        default: break;
-        }
-
-        phaseState = std::fmod(phaseState + phaseInc, 1.f);
-    }
-}
-
-float Oscillator::process()
-{
-    float osc { 0.f };
-
     switch (type)
     {
     case Sin:
-        osc = std::sin(static_cast<float>(2.0 * M_PI) * phaseState);
+        processBlock<Sin>(output, numSamples);
         break;
 
     case TriAliased:
-        osc = 4.f * std::fabs(phaseState - 0.5f) - 1.f;
+        processBlock<TriAliased>(output, numSamples);
         break;
 
     case SawAliased:
-        osc = 2.f * phaseState - 1.f;
+        processBlock<SawAliased>(output, numSamples);
         break;
 
     case TriAA:
-        osc = dpwTri();
+        processBlock<TriAA>(output, numSamples);
         break;
 
     case SawAA:
-        osc = dpwSaw();
+        processBlock<SawAA>(output, numSamples);
+        break;
+
+    case SawPolyBlep:
+        processBlock<SawPolyBlep>(output, numSamples);
+        break;
+
+    case SqrPolyBlep:
+        processBlock<SqrPolyBlep>(output, numSamples);
+        break;
+
+    case PulsePolyBlep:
+        processBlock<PulsePolyBlep>(output, numSamples);
+        break;
+
+    case TriPolyBlamp:
+        processBlock<TriPolyBlamp>(output, numSamples);
         break;
 
     default: break;
     }
+}
 
-    phaseState = std::fmod(phaseState + phaseInc, 1.f);
+float Oscillator::process()
+{
+    float osc { 0.f };
+    process(&osc, 1);
 
     return osc;
 }
 
 void Oscillator::setFrequency(float freqHz)
 {
-    frequency = std::clamp(freqHz, 0.1f, 10000.f);
-
-    phaseInc = static_cast<float>(1.0 / sampleRate) * frequency;
-    differentiatorCoeff = static_cast<float>(sampleRate) / (4.f * frequency * (1.f - frequency / static_cast<float>(sampleRate)));
+    frequency = std::clamp(freqHz, 0.1f, 20000.f);
+    updateIncrement();
 }
 
 void Oscillator::setType(OscType newType)
@@ -107,46 +126,152 @@ void Oscillator::setType(OscType newType)
     type = newType;
 
     // reset states
-    phaseState = 0.f;
+    phaseState = 0;
     differentiatorState = 0.f;
+
+    // The frequency limit depends on the waveform
+    updateIncrement();
 }
 
-float Oscillator::dpwSaw()
+void Oscillator::setPulseWidth(float width)
 {
-    // unipolar to bipolar
-    float bipolar = 2.f * phaseState - 1.f;
+    pulseWidth = std::clamp(width, 0.01f, 0.99f);
 
-    // power of 2
-    bipolar *= bipolar;
+    // The pulse rises at 1 - width of the cycle
+    edgePhase = Phase::fromCycles(1.0 - pulseWidth);
+}
 
-    // diffierentiator
-    float output = bipolar - differentiatorState;
-    differentiatorState = bipolar;
+void Oscillator::updateIncrement()
+{
+    const bool isDpw { type == SawAA || type == TriAA };
+    const float limitedFrequency { isDpw ? std::min(frequency, DpwMaxFrequency) : frequency };
 
-    // apply compensation coeff and return
-    return output * differentiatorCoeff;
+    phaseInc = Phase::increment(limitedFrequency, sampleRate);
+
+    cycleIncrement = static_cast<float>(phaseInc / Phase::StepsPerCycle);
+    samplesPerCycle = phaseInc > 0 ? static_cast<float>(Phase::StepsPerCycle / phaseInc) : 0.f;
+
+    // fs / (4 f (1 - f / fs)) from the increment in use, so it matches the rendered frequency
+    differentiatorCoeff = phaseInc > 0 ? 1.f / (4.f * cycleIncrement * (1.f - cycleIncrement)) : 0.f;
 }
 
-float Oscillator::dpwTri()
+template<Oscillator::OscType waveform>
+void Oscillator::processBlock(float* output, unsigned int numSamples)
 {
-    // unipolar to bipolar
-    float bipolar = 2.f * phaseState - 1.f;
+    for (unsigned int n = 0; n < numSamples; n += ChunkSize)
+        processChunk<waveform>(output + n, std::min(numSamples - n, ChunkSize));
+}
 
-    // power of 2
-    float parabola = bipolar * bipolar;
+template<Oscillator::OscType waveform>
+void Oscillator::processChunk(float* output, unsigned int numSamples)
+{
+    using Simd::Float4;
 
-    // add 1 offset
-    float offset = 1.f - parabola;
+    // Whole registers, the samples past numSamples are computed and dropped
+    const unsigned int vectorSamples { (numSamples + Simd::Lanes - 1u) / Simd::Lanes * Simd::Lanes };
 
-    // square wave
-    float square = std::copysign(1.f, bipolar) * offset;
+    // Bipolar phase of every sample, after the last differentiator input of the previous chunk
+    float x[ChunkSize + 1u];
+    x[0] = differentiatorState;
+    for (unsigned int n = 0; n < vectorSamples; ++n)
+        x[n + 1u] = Phase::bipolar(phaseState + phaseInc * n);
 
-    // diffierentiator - clip above 0.f to about spike
-    float output = std::fmin(square - differentiatorState, 0.f);
-    differentiatorState = square;
+    // Bipolar phase from the rising edge of the pulse
+    float e[ChunkSize];
+    if constexpr (waveform == PulsePolyBlep)
+    {
+        for (unsigned int n = 0; n < vectorSamples; ++n)
+            e[n] = Phase::bipolar(phaseState - edgePhase + phaseInc * n);
+    }
+
+    phaseState += phaseInc * numSamples;
+
+    const Float4 zero { Float4::broadcast(0.f) };
+    const Float4 one { Float4::broadcast(1.f) };
+    const Float4 coeff { Float4::broadcast(differentiatorCoeff) };
+    const Float4 halfSamplesPerCycle { Float4::broadcast(0.5f * samplesPerCycle) };
+
+    float y[ChunkSize];
+    for (unsigned int n = 0; n < vectorSamples; n += Simd::Lanes)
+    {
+        const Float4 bipolar { Float4::load(x + n + 1u) };
+
+        if constexpr (waveform == Sin)
+        {
+            // sin(2 pi p) = -sin(pi (2p - 1))
+            (zero - FastMath::sin(Float4::broadcast(static_cast<float>(M_PI)) * bipolar)).store(y + n);
+        }
+        else if constexpr (waveform == TriAliased)
+        {
+            (Float4::broadcast(2.f) * Simd::max(bipolar, zero - bipolar) - one).store(y + n);
+        }
+        else if constexpr (waveform == SawAliased)
+        {
+            bipolar.store(y + n);
+        }
+        else if constexpr (waveform == SawAA)
+        {
+            // power of 2
+            (bipolar * bipolar).store(x + n + 1u);
+        }
+        else if constexpr (waveform == TriAA)
+        {
+            // add 1 offset to the negated parabola and take the sign of the ramp
+            (sign(bipolar) * (one - bipolar * bipolar)).store(x + n + 1u);
+        }
+        else if constexpr (waveform == SawPolyBlep)
+        {
+            polyBlepSaw(bipolar, halfSamplesPerCycle).store(y + n);
+        }
+        else if constexpr (waveform == PulsePolyBlep)
+        {
+            // Difference of two saws, the second one delayed to the rising edge, centered back on 0
+            const Float4 delayed { Float4::load(e + n) };
+            const Float4 offset { Float4::broadcast(2.f * pulseWidth - 1.f) };
+            (polyBlepSaw(bipolar, halfSamplesPerCycle) - polyBlepSaw(delayed, halfSamplesPerCycle) + offset).store(y + n);
+        }
+        else if constexpr (waveform == SqrPolyBlep || waveform == TriPolyBlamp)
+        {
+            // Both edges sit where the magnitude of the phase is 0 or 1, half a cycle apart,
+            // so their weights only depend on the samples from the nearest one in either direction
+            const Float4 magnitude { Simd::max(bipolar, zero - bipolar) };
+            const Float4 middleWeight { Simd::max(one - magnitude * halfSamplesPerCycle, zero) };
+            const Float4 startWeight { Simd::max(one - (one - magnitude) * halfSamplesPerCycle, zero) };
+
+            if constexpr (waveform == SqrPolyBlep)
+            {
+                // Steps of 2 up at the middle and down at the start, the PolyBLEP residual of a
+                // unit step is -weight^2 / 2 after it and weight^2 / 2 before it
+                (sign(bipolar) * (one - middleWeight * middleWeight - startWeight * startWeight)).store(y + n);
+            }
+            else
+            {
+                // The slope turns by 8 per cycle at the trough and by -8 at the peak, the PolyBLAMP
+                // residual of a turn by one per sample is weight^3 / 6 on either side
+                const Float4 residual { middleWeight * middleWeight * middleWeight - startWeight * startWeight * startWeight };
+                (Float4::broadcast(2.f) * magnitude - one + Float4::broadcast(4.f / 3.f * cycleIncrement) * residual).store(y + n);
+            }
+        }
+    }
+
+    if constexpr (waveform == SawAA || waveform == TriAA)
+    {
+        // differentiator over the chunk, every sample minus the one before
+        for (unsigned int n = 0; n < vectorSamples; n += Simd::Lanes)
+        {
+            const Float4 difference { Float4::load(x + n + 1u) - Float4::load(x + n) };
+
+            // apply compensation coeff, the triangle clips above 0 to avoid the spike
+            if constexpr (waveform == SawAA)
+                (difference * coeff).store(y + n);
+            else
+                (Float4::broadcast(2.f) * (Simd::min(difference, zero) * coeff) + one).store(y + n);
+        }
+
+        differentiatorState = x[numSamples];
+    }
 
-    // apply compensation coeff and return
-    return 2.f * (output * differentiatorCoeff) + 1.f;
+    std::copy(y, y + numSamples, output);
 }
 
 }
@@ -1,8 +1,17 @@
 #pragma once
 
+#include <cstdint>
+
 namespace DSP
 {
 
+// Audio rate oscillator
+// The phase is a 32 bit integer accumulator that wraps by itself, the waveform is selected
+// once per block and every kernel runs Simd::Lanes samples at a time, the Sin on the
+// FastMath approximation and the DPW differentiators over the block
+// The PolyBLEP and PolyBLAMP modes take the trivial waveform and correct the two samples
+// around every step or corner with a polynomial residual, which keeps the aliasing well below
+// the DPW modes up to Nyquist for a few multiply-adds and without branches
 class Oscillator
 {
 public:
@@ -12,7 +21,11 @@ public:
         TriAliased,
         SawAliased,
         TriAA,
-        SawAA
+        SawAA,
+        SawPolyBlep,
+        SqrPolyBlep,
+        PulsePolyBlep,
+        TriPolyBlamp
     };
 
     Oscillator();
@@ -32,28 +45,51 @@ public:
     // Process a single sample of the oscillator
     float process();
 
-    // Set a new frequency for the oscillator in Hz
+    // Set a new frequency for the oscillator in Hz, up to 20 kHz
+    // SawAA and TriAA stop at DpwMaxFrequency, their differentiators fall apart towards Nyquist
     void setFrequency(float freqHz);
 
     // Select the waveform type
     void setType(OscType type);
 
+    // Set the share of the cycle spent high by PulsePolyBlep, from 0.01 to 0.99
+    void setPulseWidth(float width);
+
 private:
+    static constexpr unsigned int ChunkSize { 64 };
+
+    static constexpr float DpwMaxFrequency { 10000.f };
+
     double sampleRate { 48000.0 };
 
     float frequency { 1.f };
     OscType type { Sin };
 
-    float phaseState { 0.f };
-    float phaseInc { 0.f };
+    // Phase and its increment per sample, a full cycle is 2^32
+    std::uint32_t phaseState { 0 };
+    std::uint32_t phaseInc { 0 };
 
     float differentiatorState { 0.f };
     float differentiatorCoeff { 0.f };
 
-    // DPW methods
+    // Share of the cycle spent high by the pulse, and the phase of its rising edge
+    float pulseWidth { 0.5f };
+    std::uint32_t edgePhase { 0x80000000u };
+
+    // Increment as a fraction of the cycle and its inverse, scaling the residuals to samples
+    float cycleIncrement { 0.f };
+    float samplesPerCycle { 0.f };
+
+    // Recalculate the phase increment, the DPW compensation and the residual scales for the frequency and sample rate
+    void updateIncrement();
+
+    // Process a buffer with one waveform
+    template<OscType waveform>
+    void processBlock(float* output, unsigned int numSamples);
 
-    float dpwTri();
-    float dpwSaw();
+    // Process up to ChunkSize samples with one waveform
+    template<OscType waveform>
+    void processChunk(float* output, unsigned int numSamples);
 };
 
 }
@@ -0,0 +1,305 @@
+#include "ParallelBiquad.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+namespace DSP
+{
+
+namespace
+{
+    using Complex = std::complex<double>;
+
+    // Evaluate b0 + b1 w + b2 w^2
+    Complex evaluateQuadratic(double c0, double c1, double c2, Complex w)
+    {
+        return c0 + w * (c1 + w * c2);
+    }
+
+    // Number of frequencies the expansion is checked against the cascade
+    const unsigned int NumCheckFrequencies { 16 };
+
+    // Maximum relative error between the cascade and parallel responses
+    constexpr double MaxResponseError { 1e-3 };
+
+    // Minimum distance between poles, closer poles are treated as repeated
+    constexpr double MinPoleDistance { 1e-9 };
+}
+
+ParallelBiquad::ParallelBiquad(unsigned int numSections, unsigned int maxNumChannels) :
+    allocatedChannels { maxNumChannels },
+    allocatedSections { numSections },
+    paddedSections { (numSections + Simd::Lanes - 1u) / Simd::Lanes * Simd::Lanes },
+    cascadeCoeffs(allocatedSections * CoeffsPerSection, 0.f),
+    numParallelCoeffs { paddedSections * ParallelCoeffsPerSection + 1u },
+    pendingCoeffs(numParallelCoeffs, 0.f),
+    parallelCoeffs(numParallelCoeffs, 0.f),
+    rampTargets(numParallelCoeffs, 0.f),
+    rampDeltas(numParallelCoeffs, 0.f),
+    states(allocatedChannels * paddedSections * 2u, 0.f)
+{
+    activeSections.reserve(allocatedSections);
+}
+
+ParallelBiquad::~ParallelBiquad()
+{
+}
+
+void ParallelBiquad::clear()
+{
+    std::fill(states.begin(), states.end(), 0.f);
+}
+
+void ParallelBiquad::reallocateChannels(unsigned int maxNumChannels)
+{
+    allocatedChannels = maxNumChannels;
+    states.resize(allocatedChannels * paddedSections * 2u);
+    std::fill(states.begin(), states.end(), 0.f);
+}
+
+void ParallelBiquad::setSectionCoeffs(const std::array<float, CoeffsPerSection>& newSectionCoeffs, unsigned int section)
+{
+    if (section < allocatedSections)
+    {
+        std::copy(newSectionCoeffs.begin(), newSectionCoeffs.end(), cascadeCoeffs.begin() + (section * CoeffsPerSection));
+        expansionDirty = true;
+    }
+}
+
+bool ParallelBiquad::updateExpansion()
+{
+    if (!expansionDirty)
+        return true;
+
+    if (expansionPending.load(std::memory_order_acquire))
+        return false;
+
+    expansionDirty = false;
+    pendingValid = expand();
+    expansionPending.store(true, std::memory_order_release);
+    return true;
+}
+
+void ParallelBiquad::pullExpansion(unsigned int numRampSamples)
+{
+    if (!expansionPending.load(std::memory_order_acquire))
+        return;
+
+    if (pendingValid)
+    {
+        // Coming from an invalid expansion there is nothing meaningful to ramp from
+        if (!expansionValid || numRampSamples == 0)
+        {
+            std::copy(pendingCoeffs.begin(), pendingCoeffs.end(), parallelCoeffs.begin());
+            rampSamplesLeft = 0;
+        }
+        else
+        {
+            const float invRampSamples { 1.f / static_cast<float>(numRampSamples) };
+            for (unsigned int i = 0; i < numParallelCoeffs; ++i)
+            {
+                rampTargets[i] = pendingCoeffs[i];
+                rampDeltas[i] = (pendingCoeffs[i] - parallelCoeffs[i]) * invRampSamples;
+            }
+
+            rampSamplesLeft = numRampSamples;
+        }
+    }
+
+    expansionValid = pendingValid;
+    expansionPending.store(false, std::memory_order_release);
+}
+
+bool ParallelBiquad::expand()
+{
+    float* b0 { pendingCoeffs.data() };
+    float* b1 { b0 + paddedSections };
+    float* a1 { b1 + paddedSections };
+    float* a2 { a1 + paddedSections };
+    float& directGain { pendingCoeffs[paddedSections * ParallelCoeffsPerSection] };
+
+    // Identity sections (flat bands, 0 dB peaks and shelves) do not take part in the expansion
+    // Their lane gets a zero residue and keeps its last poles, so old states ring out
+    activeSections.clear();
+    for (unsigned int s = 0; s < allocatedSections; ++s)
+    {
+        const float* c { cascadeCoeffs.data() + s * CoeffsPerSection };
+        const bool isIdentity { std::fabs(c[0] - 1.f) < 1e-6f && std::fabs(c[1] - c[3]) < 1e-6f && std::fabs(c[2] - c[4]) < 1e-6f };
+        if (isIdentity)
+        {
+            b0[s] = 0.f;
+            b1[s] = 0.f;
+            continue;
+        }
+
+        // Only proper second order sections can be expanded
+        if (std::fabs(c[4]) < 1e-9f)
+            return false;
+
+        activeSections.push_back(s);
+    }
+
+    // Numerator and denominator of the whole cascade at w = z^-1
+    auto cascadeNumerator = [this] (Complex w)
+    {
+        Complex n { 1.0 };
+        for (auto s : activeSections)
+        {
+            const float* c { cascadeCoeffs.data() + s * CoeffsPerSection };
+            n *= evaluateQuadratic(c[0], c[1], c[2], w);
+        }
+        return n;
+    };
+
+    auto sectionDenominator = [this] (unsigned int s, Complex w)
+    {
+        const float* c { cascadeCoeffs.data() + s * CoeffsPerSection };
+        return evaluateQuadratic(1.0, c[3], c[4], w);
+    };
+
+    double direct { 1.0 };
+    for (auto s : activeSections)
+        direct *= cascadeCoeffs[s * CoeffsPerSection];
+
+    for (auto s : activeSections)
+    {
+        const double sa1 { cascadeCoeffs[s * CoeffsPerSection + 3] };
+        const double sa2 { cascadeCoeffs[s * CoeffsPerSection + 4] };
+
+        // Poles of the section in z and their reciprocals in w = z^-1
+        const Complex disc { std::sqrt(Complex(sa1 * sa1 - 4.0 * sa2)) };
+        const Complex p1 { (-sa1 + disc) * 0.5 };
+        const Complex p2 { (-sa1 - disc) * 0.5 };
+        if (std::abs(p1 - p2) < MinPoleDistance)
+            return false;
+
+        const Complex w[2] { 1.0 / p1, 1.0 / p2 };
+        Complex r[2];
+
+        // Residues of the cascade at both poles
+        for (unsigned int k = 0; k < 2; ++k)
+        {
+            Complex den { sa1 + 2.0 * sa2 * w[k] };
+            for (auto other : activeSections)
+            {
+                if (other == s)
+                    continue;
+
+                const Complex otherDen { sectionDenominator(other, w[k]) };
+                if (std::abs(otherDen) < MinPoleDistance)
+                    return false;
+
+                den *= otherDen;
+            }
+
+            r[k] = cascadeNumerator(w[k]) / den;
+        }
+
+        // r1 / (w - w1) + r2 / (w - w2) over the section denominator a2 (w - w1) (w - w2)
+        const double pb0 { -sa2 * (r[0] * w[1] + r[1] * w[0]).real() };
+        const double pb1 { sa2 * (r[0] + r[1]).real() };
+        if (!std::isfinite(pb0) || !std::isfinite(pb1))
+            return false;
+
+        b0[s] = static_cast<float>(pb0);
+        b1[s] = static_cast<float>(pb1);
+        a1[s] = static_cast<float>(sa1);
+        a2[s] = static_cast<float>(sa2);
+        direct -= pb0;
+    }
+
+    directGain = static_cast<float>(direct);
+
+    // Check the rounded parallel coefficients against the cascade, ill conditioned
+    // expansions (heavily overlapping bands) lose too much precision to be used
+    for (unsigned int f = 0; f < NumCheckFrequencies; ++f)
+    {
+        const double omega { M_PI * std::pow(0.5, 0.75 * f) };
+        const Complex w { std::polar(1.0, -omega) };
+
+        Complex cascade { cascadeNumerator(w) };
+        for (auto s : activeSections)
+            cascade /= sectionDenominator(s, w);
+
+        Complex parallel { directGain };
+        for (auto s : activeSections)
+            parallel += evaluateQuadratic(b0[s], b1[s], 0.0, w) / evaluateQuadratic(1.0, a1[s], a2[s], w);
+
+        if (!(std::abs(parallel - cascade) <= MaxResponseError * std::abs(cascade) + 1e-5))
+            return false;
+    }
+
+    return true;
+}
+
+void ParallelBiquad::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    numChannels = std::min(numChannels, allocatedChannels);
+
+    // The coeff ramp advances once per sample, so go frame by frame while ramping
+    unsigned int n { 0 };
+    for (; n < numSamples && rampSamplesLeft > 0; ++n)
+    {
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+            output[ch][n] = processSections(input[ch][n], ch);
+
+        advanceCoeffRamp();
+    }
+
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        for (unsigned int m = n; m < numSamples; ++m)
+            output[ch][m] = processSections(input[ch][m], ch);
+}
+
+void ParallelBiquad::process(float* output, const float* input, unsigned int numChannels)
+{
+    numChannels = std::min(numChannels, allocatedChannels);
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        output[ch] = processSections(input[ch], ch);
+
+    if (rampSamplesLeft > 0)
+        advanceCoeffRamp();
+}
+
+void ParallelBiquad::advanceCoeffRamp()
+{
+    // land exactly on the target
+    if (--rampSamplesLeft == 0)
+    {
+        std::copy(rampTargets.begin(), rampTargets.end(), parallelCoeffs.begin());
+        return;
+    }
+
+    for (unsigned int i = 0; i < numParallelCoeffs; ++i)
+        parallelCoeffs[i] += rampDeltas[i];
+}
+
+float ParallelBiquad::processSections(float x, unsigned int channel)
+{
+    float* z1 { states.data() + channel * paddedSections * 2u };
+    float* z2 { z1 + paddedSections };
+
+    const float* b0 { parallelCoeffs.data() };
+    const float* b1 { b0 + paddedSections };
+    const float* a1 { b1 + paddedSections };
+    const float* a2 { a1 + paddedSections };
+    const float directGain { parallelCoeffs[paddedSections * ParallelCoeffsPerSection] };
+
+    const Simd::Float4 xv { Simd::Float4::broadcast(x) };
+    const Simd::Float4 zero { Simd::Float4::broadcast(0.f) };
+    Simd::Float4 acc { zero };
+
+    // Transposed direct form II for every section, all sections only depend on x
+    for (unsigned int s = 0; s < paddedSections; s += Simd::Lanes)
+    {
+        const Simd::Float4 y { Simd::Float4::load(b0 + s) * xv + Simd::Float4::load(z1 + s) };
+        (Simd::Float4::load(b1 + s) * xv - Simd::Float4::load(a1 + s) * y + Simd::Float4::load(z2 + s)).store(z1 + s);
+        (zero - Simd::Float4::load(a2 + s) * y).store(z2 + s);
+        acc = acc + y;
+    }
+
+    return directGain * x + acc.sum();
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Biquad.h"
+#include "Simd.h"
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+namespace DSP
+{
+
+// Parallel realization of a biquad cascade
+// The cascade is expanded in partial fractions into a direct gain plus
+// one (b0 + b1 z^-1) / (1 + a1 z^-1 + a2 z^-2) section per pole pair,
+// so every section only depends on the input and groups of Simd::Lanes
+// sections run side by side, with their outputs summed
+// Lane i always holds the pole pair of cascade section i, so the states stay
+// with their section when other sections change or become an identity
+// The expansion is calculated by the thread calling updateExpansion and picked up
+// by the audio thread, which ramps the parallel coeffs towards it
+class ParallelBiquad
+{
+public:
+    ParallelBiquad(unsigned int numSections, unsigned int maxNumChannels);
+    ~ParallelBiquad();
+
+    // No default ctor
+    ParallelBiquad() = delete;
+
+    // No copy semantics
+    ParallelBiquad(const ParallelBiquad&) = delete;
+    const ParallelBiquad& operator=(const ParallelBiquad&) = delete;
+
+    // No move semantics
+    ParallelBiquad(ParallelBiquad&&) = delete;
+    const ParallelBiquad& operator=(ParallelBiquad&&) = delete;
+
+    static const unsigned int CoeffsPerSection = Biquad::CoeffsPerSection;
+
+    // Clear all states
+    void clear();
+
+    // Reallocate state storage
+    // Calling this method will clear the states
+    void reallocateChannels(unsigned int maxNumChannels);
+
+    // Set new coeffs to a section of the equivalent cascade
+    // Same format as Biquad, the expansion is deferred to updateExpansion
+    // Must be called from the same thread as updateExpansion
+    void setSectionCoeffs(const std::array<float, CoeffsPerSection>& newSectionCoeffs, unsigned int section);
+
+    // Expand the cascade into parallel form if any section changed and hand it to pullExpansion
+    // A cascade with repeated or nearly repeated poles, first order or FIR sections
+    // cannot be realized in parallel and is handed over as invalid
+    // Lock-free, must only be called from one thread at a time besides the audio thread
+    // Returns false if the previous expansion has not been picked up yet
+    bool updateExpansion();
+
+    // Take the last expansion handed over by updateExpansion, if any
+    // The parallel coeffs are ramped towards it over numRampSamples processed samples
+    // Meant for the audio thread, once per block or control sub-block
+    void pullExpansion(unsigned int numRampSamples);
+
+    // Whether the expansion in use realizes the cascade, as of the last pullExpansion
+    bool isExpansionValid() const noexcept { return expansionValid; }
+
+    // Whether an expansion handed over by updateExpansion waits for pullExpansion
+    bool isExpansionPending() const noexcept { return expansionPending.load(std::memory_order_acquire); }
+
+    // Process audio
+    // This method can be called with a lower number of channels than allocated
+    // Output is only valid while isExpansionValid
+    void process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples);
+
+    // Process audio
+    // Single sample flavour
+    void process(float* output, const float* input, unsigned int numChannels);
+
+    // return the number of currently allocated channels
+    unsigned int getAllocatedChannels() const noexcept { return allocatedChannels; }
+
+    // return the number of cascade sections
+    unsigned int getAllocatedSections() const noexcept { return allocatedSections; }
+
+private:
+    unsigned int allocatedChannels { 0 };
+    unsigned int allocatedSections { 0 };
+
+    // sections rounded up to a multiple of Simd::Lanes
+    unsigned int paddedSections { 0 };
+
+    // cascade coeffs [sos0_b0, sos0_b1, sos0_b2, sos0_a1, sos0_a2, sos1_b0, ...]
+    // Only touched by the thread calling setSectionCoeffs and updateExpansion
+    std::vector<float> cascadeCoeffs;
+    bool expansionDirty { true };
+
+    // indices of the cascade sections that are not an identity
+    std::vector<unsigned int> activeSections;
+
+    // parallel coeffs in structure of arrays layout followed by the direct
+    // input to output gain, padding lanes are zero
+    // [b0_sos0, b0_sos1, ... , b0_sosN, b1_sos0, ... , b1_sosN, a1_sos0, ... , a2_sosN, direct]
+    static const unsigned int ParallelCoeffsPerSection = 4;
+    unsigned int numParallelCoeffs { 0 };
+
+    // Expansion handed from updateExpansion to pullExpansion, owned by
+    // updateExpansion while expansionPending is false and by pullExpansion otherwise
+    std::vector<float> pendingCoeffs;
+    bool pendingValid { false };
+    std::atomic<bool> expansionPending { false };
+
+    // Audio thread side, the coeffs in use and their ramp towards the last expansion
+    std::vector<float> parallelCoeffs;
+    std::vector<float> rampTargets;
+    std::vector<float> rampDeltas;
+    unsigned int rampSamplesLeft { 0 };
+    bool expansionValid { false };
+
+    // states of all channels, two per section
+    // [ch0_z1_sos0, ... , ch0_z1_sosN, ch0_z2_sos0, ... , ch0_z2_sosN, ch1_z1_sos0, ...]
+    std::vector<float> states;
+
+    // Expand the cascade into pendingCoeffs, returns false if it cannot be realized
+    bool expand();
+
+    // Move the coeffs in use one sample towards the ramp targets
+    void advanceCoeffRamp();
+
+    // Run one sample of a channel thru all parallel sections
+    float processSections(float x, unsigned int channel);
+};
+
+}
\ No newline at end of file
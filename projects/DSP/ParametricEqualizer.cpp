@@ -1,86 +1,617 @@
 #include "ParametricEqualizer.h"
 
+#include "FastMath.h"
+
+#include <algorithm>
 #include <cmath>
+#include <complex>
+#include <condition_variable>
+#include <thread>
 
 namespace DSP
 {
 
+// One thread serves every equalizer of the process, it is started with the first one and
+// joined with the last one, and sleeps on a condition variable between requests
+// The lock is only held to flag and scan requests, never during a design, so the audio
+// thread requesting a design waits at most for a scan of the registered equalizers
+class ParametricEqualizer::Designer
+{
+public:
+    static Designer& get()
+    {
+        static Designer designer;
+        return designer;
+    }
+
+    void add(ParametricEqualizer* equalizer)
+    {
+        std::lock_guard<std::mutex> lifetime { lifetimeMutex };
+        std::lock_guard<std::mutex> lock { mutex };
+
+        if (equalizers.empty())
+        {
+            running = true;
+            thread = std::thread([this] { run(); });
+        }
+
+        equalizers.push_back(equalizer);
+    }
+
+    void remove(ParametricEqualizer* equalizer)
+    {
+        std::lock_guard<std::mutex> lifetime { lifetimeMutex };
+        std::thread finished;
+        {
+            std::unique_lock<std::mutex> lock { mutex };
+            equalizers.erase(std::find(equalizers.begin(), equalizers.end(), equalizer));
+
+            // The indices of a running scan moved, so it scans again
+            requested = true;
+            idle.wait(lock, [this, equalizer] { return designing != equalizer; });
+
+            if (equalizers.empty())
+            {
+                running = false;
+                finished = std::move(thread);
+            }
+        }
+
+        wake.notify_one();
+        if (finished.joinable())
+            finished.join();
+    }
+
+    void request()
+    {
+        {
+            std::lock_guard<std::mutex> lock { mutex };
+            requested = true;
+        }
+
+        wake.notify_one();
+    }
+
+private:
+    std::mutex lifetimeMutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::thread thread;
+    std::vector<ParametricEqualizer*> equalizers;
+    ParametricEqualizer* designing { nullptr };
+    bool requested { false };
+    bool running { false };
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock { mutex };
+        while (true)
+        {
+            wake.wait(lock, [this] { return requested || !running; });
+            if (!running)
+                return;
+
+            requested = false;
+            for (size_t i = 0; i < equalizers.size(); ++i)
+            {
+                ParametricEqualizer* equalizer { equalizers[i] };
+                if (!equalizer->designRequested.exchange(false, std::memory_order_acq_rel))
+                    continue;
+
+                designing = equalizer;
+                lock.unlock();
+                equalizer->runDesign();
+                lock.lock();
+                designing = nullptr;
+                idle.notify_all();
+            }
+        }
+    }
+};
+
 ParametricEqualizer::ParametricEqualizer(unsigned int numOfBands, unsigned int maxNumChannels) :
     biquad(numOfBands, maxNumChannels),
-    bands(numOfBands)
+    parallelBiquad(numOfBands, maxNumChannels),
+    bands(numOfBands),
+    pendingBands(numOfBands),
+    bandCoeffs(numOfBands * DSP::Biquad::CoeffsPerSection, 0.f),
+    subBlockOutput(maxNumChannels, nullptr),
+    subBlockInput(maxNumChannels, nullptr),
+    crossfadeBuffer(maxNumChannels * ControlBlockSize, 0.f),
+    crossfadeOutput(maxNumChannels, nullptr),
+    designBands(numOfBands),
+    designBandCoeffs(numOfBands * DSP::Biquad::CoeffsPerSection, 0.f),
+    parallelRampSamples { static_cast<unsigned int>(sampleRate * ParallelRampMs / 1000.0) }
 {
-    unsigned int b { 0 };
-    for (const auto& band : bands)
-        biquad.setSectionCoeffs(calculateCoeffs(band), b++);
+    changedBands.reserve(numOfBands);
+
+    calculateCoeffs(bands.data(), static_cast<unsigned int>(bands.size()), sampleRate, bandCoeffs.data());
+    for (unsigned int b = 0; b < bands.size(); ++b)
+        setBandCoeffs(b, 0);
+
+    designRealizations();
+    parallelBiquad.pullExpansion(0);
+    Designer::get().add(this);
 }
 
 ParametricEqualizer::~ParametricEqualizer()
 {
+    Designer::get().remove(this);
 }
 
 void ParametricEqualizer::clear()
 {
     biquad.clear();
+    parallelBiquad.clear();
+
+    if (convolver)
+        convolver->clear();
+
+    crossfadeSamplesLeft = 0;
 }
 
 void ParametricEqualizer::prepare(double newSampleRate, unsigned int maxNumChannels)
 {
+    // The designer shares the parallel form and the convolver, so it waits while they change
+    std::lock_guard<std::mutex> lock { designLock };
+
     biquad.reallocateChannels(maxNumChannels);
+    parallelBiquad.reallocateChannels(maxNumChannels);
+    subBlockOutput.resize(maxNumChannels, nullptr);
+    subBlockInput.resize(maxNumChannels, nullptr);
+    crossfadeBuffer.assign(maxNumChannels * ControlBlockSize, 0.f);
+    crossfadeOutput.resize(maxNumChannels, nullptr);
+    crossfadeSamplesLeft = 0;
+
+    if (convolver)
+        convolver->reallocateChannels(maxNumChannels);
 
     sampleRate = std::fmax(newSampleRate, 1.f);
+    parallelRampSamples = static_cast<unsigned int>(sampleRate * ParallelRampMs / 1000.0);
+
+    pendingSampleRate.store(sampleRate, std::memory_order_relaxed);
+    settingsVersion.fetch_add(1, std::memory_order_release);
+
+    // Take all pending settings without ramping
+    for (unsigned int b = 0; b < bands.size(); ++b)
+        pendingBands[b].changed.store(true, std::memory_order_release);
 
-    unsigned int b { 0 };
-    for (const auto& band : bands)
-        biquad.setSectionCoeffs(calculateCoeffs(band), b++);
+    anyBandChanged.store(true, std::memory_order_release);
+    designDirty.store(false, std::memory_order_relaxed);
+    handOverDesigns();
+
+    pullBandChanges(0);
+    controlSamplesLeft = ControlBlockSize;
 }
 
 void ParametricEqualizer::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
 {
-    biquad.process(output, input, numChannels, numSamples);
+    numChannels = std::min(numChannels, static_cast<unsigned int>(subBlockOutput.size()));
+
+    unsigned int n { 0 };
+    while (n < numSamples)
+    {
+        if (controlSamplesLeft == 0)
+        {
+            pullBandChanges(ControlBlockSize);
+            controlSamplesLeft = ControlBlockSize;
+        }
+
+        const unsigned int subBlockSize { std::min(numSamples - n, controlSamplesLeft) };
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+        {
+            subBlockOutput[ch] = output[ch] + n;
+            subBlockInput[ch] = input[ch] + n;
+        }
+
+        processSubBlock(numChannels, subBlockSize);
+
+        n += subBlockSize;
+        controlSamplesLeft -= subBlockSize;
+    }
 }
 
 void ParametricEqualizer::process(float* output, const float* input, unsigned int numChannels)
 {
-    biquad.process(output, input, numChannels);
+    if (controlSamplesLeft == 0)
+    {
+        pullBandChanges(ControlBlockSize);
+        controlSamplesLeft = ControlBlockSize;
+    }
+
+    --controlSamplesLeft;
+
+    // One sample sub-block over the frame
+    numChannels = std::min(numChannels, static_cast<unsigned int>(subBlockOutput.size()));
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        subBlockOutput[ch] = output + ch;
+        subBlockInput[ch] = input + ch;
+    }
+
+    processSubBlock(numChannels, 1);
+}
+
+void ParametricEqualizer::prepareLinearPhase(unsigned int newFirLength, unsigned int blockSize)
+{
+    std::lock_guard<std::mutex> lock { designLock };
+
+    firLength = std::max(newFirLength | 1u, 3u);
+    convolver = std::make_unique<DSP::PartitionedConvolver>(blockSize, firLength, static_cast<unsigned int>(subBlockOutput.size()));
+
+    // Zero phase response sampled densely enough to keep time aliasing of long band responses low
+    unsigned int fftSize { 4 };
+    while (fftSize < 4u * firLength)
+        fftSize *= 2;
+
+    firFft = std::make_unique<DSP::Fft>(fftSize);
+    firSpectrumReal.resize(firFft->getNumBins());
+    firSpectrumImag.assign(firFft->getNumBins(), 0.f);
+    firImpulse.resize(fftSize);
+    fir.resize(firLength);
+
+    designDirty.store(false, std::memory_order_relaxed);
+    handOverDesigns();
+}
+
+unsigned int ParametricEqualizer::getLinearPhaseLatency() const
+{
+    return convolver ? convolver->getLatency() + firLength / 2 : 0;
 }
 
 void ParametricEqualizer::setBandType(unsigned int band, FilterType type)
 {
-    if (band < bands.size() && band < biquad.getAllocatedSections())
+    if (band < pendingBands.size())
     {
-        bands[band].type = type;
-        biquad.setSectionCoeffs(calculateCoeffs(bands[band]), band);
+        pendingBands[band].type.store(type, std::memory_order_relaxed);
+        markBandChanged(band);
     }
 }
 
 void ParametricEqualizer::setBandFrequency(unsigned int band, float frequency)
 {
-    if (band < bands.size() && band < biquad.getAllocatedSections())
+    if (band < pendingBands.size())
     {
-        bands[band].freq = std::fmax(frequency, 2.f);
-        biquad.setSectionCoeffs(calculateCoeffs(bands[band]), band);
+        pendingBands[band].freq.store(std::fmax(frequency, 2.f), std::memory_order_relaxed);
+        markBandChanged(band);
     }
 }
 
 void ParametricEqualizer::setBandResonance(unsigned int band, float resonance)
 {
-    if (band < bands.size() && band < biquad.getAllocatedSections())
+    if (band < pendingBands.size())
     {
-        bands[band].reso = std::fmax(resonance, 0.1f);
-        biquad.setSectionCoeffs(calculateCoeffs(bands[band]), band);
+        pendingBands[band].reso.store(std::fmax(resonance, 0.1f), std::memory_order_relaxed);
+        markBandChanged(band);
     }
 }
 
 void ParametricEqualizer::setBandGain(unsigned int band, float gain)
 {
-    if (band < bands.size() && band < biquad.getAllocatedSections())
+    if (band < pendingBands.size())
+    {
+        pendingBands[band].gain.store(gain, std::memory_order_relaxed);
+        markBandChanged(band);
+    }
+}
+
+void ParametricEqualizer::setResponseFrequencies(const float* frequencies, unsigned int numPoints)
+{
+    const unsigned int paddedPoints { (numPoints + Simd::Lanes - 1u) / Simd::Lanes * Simd::Lanes };
+    responseFrequencies.assign(paddedPoints, 0.f);
+    std::copy(frequencies, frequencies + numPoints, responseFrequencies.begin());
+    responsePhi.assign(paddedPoints, 0.f);
+    responseSquared.assign(paddedPoints, 1.f);
+    responseMagnitudes.assign(numPoints, 0.f);
+    responseBands.resize(bands.size());
+    responseBandCoeffs.resize(bands.size() * DSP::Biquad::CoeffsPerSection);
+    responseTerms.resize(bands.size() * ResponseTermsPerBand);
+    responseSampleRate = 0.0;
+    responseValid = false;
+}
+
+bool ParametricEqualizer::updateResponse()
+{
+    const unsigned int version { settingsVersion.load(std::memory_order_acquire) };
+    if (responseValid && version == responseVersion)
+        return false;
+
+    responseValid = true;
+    responseVersion = version;
+
+    // Settings changed while taking the snapshot bump the version again and are picked up next call
+    snapshotPendingBands(responseBands);
+    const double snapshotSampleRate { pendingSampleRate.load(std::memory_order_relaxed) };
+
+    if (snapshotSampleRate != responseSampleRate)
+    {
+        responseSampleRate = snapshotSampleRate;
+        for (unsigned int p = 0; p < responseFrequencies.size(); ++p)
+        {
+            const double s { std::sin(M_PI * responseFrequencies[p] / responseSampleRate) };
+            responsePhi[p] = static_cast<float>(s * s);
+        }
+    }
+
+    const unsigned int numBands { static_cast<unsigned int>(responseBands.size()) };
+    calculateCoeffs(responseBands.data(), numBands, responseSampleRate, responseBandCoeffs.data());
+
+    // |H|^2 of a section is S + L phi + Q phi^2 over the same for the denominator, with phi = sin^2(w / 2)
+    // The terms are formed in double, as they cancel for bands far below the sample rate
+    for (unsigned int b = 0; b < numBands; ++b)
+    {
+        const float* c { responseBandCoeffs.data() + b * DSP::Biquad::CoeffsPerSection };
+        const double b0 { c[0] }, b1 { c[1] }, b2 { c[2] }, a1 { c[3] }, a2 { c[4] };
+        float* t { responseTerms.data() + b * ResponseTermsPerBand };
+
+        const double bSum { b0 + b1 + b2 };
+        const double aSum { 1.0 + a1 + a2 };
+        t[0] = static_cast<float>(bSum * bSum);
+        t[1] = static_cast<float>(-4.0 * (b0 * b1 + 4.0 * b0 * b2 + b1 * b2));
+        t[2] = static_cast<float>(16.0 * b0 * b2);
+        t[3] = static_cast<float>(aSum * aSum);
+        t[4] = static_cast<float>(-4.0 * (a1 + 4.0 * a2 + a1 * a2));
+        t[5] = static_cast<float>(16.0 * a2);
+    }
+
+    // Clamped to +-300 dB so any number of bands can be multiplied in float
+    const Simd::Float4 minSquared { Simd::Float4::broadcast(1e-30f) };
+    const Simd::Float4 maxSquared { Simd::Float4::broadcast(1e30f) };
+
+    for (unsigned int p = 0; p < responsePhi.size(); p += Simd::Lanes)
+    {
+        const Simd::Float4 phi { Simd::Float4::load(responsePhi.data() + p) };
+        Simd::Float4 squared { Simd::Float4::broadcast(1.f) };
+
+        for (unsigned int b = 0; b < numBands; ++b)
+        {
+            const float* t { responseTerms.data() + b * ResponseTermsPerBand };
+            const Simd::Float4 num { Simd::Float4::broadcast(t[0]) + phi * (Simd::Float4::broadcast(t[1]) + phi * Simd::Float4::broadcast(t[2])) };
+            const Simd::Float4 den { Simd::Float4::broadcast(t[3]) + phi * (Simd::Float4::broadcast(t[4]) + phi * Simd::Float4::broadcast(t[5])) };
+            squared = Simd::min(Simd::max(squared * num / den, minSquared), maxSquared);
+        }
+
+        squared.store(responseSquared.data() + p);
+    }
+
+    for (unsigned int p = 0; p < responseMagnitudes.size(); ++p)
+        responseMagnitudes[p] = 10.f * std::log10(std::fmax(responseSquared[p], 1e-30f));
+
+    return true;
+}
+
+void ParametricEqualizer::setTopology(DSP::Biquad::Topology topology)
+{
+    biquad.setTopology(topology);
+}
+
+void ParametricEqualizer::setRealization(Realization newRealization)
+{
+    realization = newRealization;
+
+    // Designs start with the first realization that needs them, Cascade renders until one lands
+    if (realization != Cascade && !designsWanted.exchange(true, std::memory_order_acq_rel))
+    {
+        awaitedDesignCount = designCount.load(std::memory_order_acquire);
+        designsCurrent = !designDirty.load(std::memory_order_acquire);
+        requestDesign();
+    }
+}
+
+void ParametricEqualizer::markBandChanged(unsigned int band)
+{
+    pendingBands[band].changed.store(true, std::memory_order_release);
+    anyBandChanged.store(true, std::memory_order_release);
+    settingsVersion.fetch_add(1, std::memory_order_release);
+    designDirty.store(true, std::memory_order_release);
+    requestDesign();
+}
+
+void ParametricEqualizer::snapshotPendingBands(std::vector<Band>& snapshot) const
+{
+    for (unsigned int b = 0; b < snapshot.size(); ++b)
+    {
+        snapshot[b].type = pendingBands[b].type.load(std::memory_order_relaxed);
+        snapshot[b].freq = pendingBands[b].freq.load(std::memory_order_relaxed);
+        snapshot[b].reso = pendingBands[b].reso.load(std::memory_order_relaxed);
+        snapshot[b].gain = pendingBands[b].gain.load(std::memory_order_relaxed);
+    }
+}
+
+void ParametricEqualizer::pullBandChanges(unsigned int numRampSamples)
+{
+    parallelBiquad.pullExpansion(numRampSamples > 0 ? parallelRampSamples : 0);
+
+    if (!designsCurrent && designCount.load(std::memory_order_acquire) != awaitedDesignCount)
+        designsCurrent = true;
+
+    // A design that found the previous one still pending is redone once that one was taken
+    if (designRetry.load(std::memory_order_relaxed) && !parallelBiquad.isExpansionPending()
+        && !(convolver && convolver->isFilterPending()) && designRetry.exchange(false, std::memory_order_acquire))
+        requestDesign();
+
+    if (!anyBandChanged.exchange(false, std::memory_order_acquire))
+        return;
+
+    // Take all changed bands first, then design every band in one batch
+    // Unchanged bands come out with the same coeffs they already have
+    changedBands.clear();
+    for (unsigned int b = 0; b < bands.size(); ++b)
+    {
+        auto& pending { pendingBands[b] };
+        if (!pending.changed.exchange(false, std::memory_order_acquire))
+            continue;
+
+        bands[b].type = pending.type.load(std::memory_order_relaxed);
+        bands[b].freq = pending.freq.load(std::memory_order_relaxed);
+        bands[b].reso = pending.reso.load(std::memory_order_relaxed);
+        bands[b].gain = pending.gain.load(std::memory_order_relaxed);
+        changedBands.push_back(b);
+    }
+
+    calculateCoeffs(bands.data(), static_cast<unsigned int>(bands.size()), sampleRate, bandCoeffs.data());
+    for (auto b : changedBands)
+        setBandCoeffs(b, numRampSamples);
+}
+
+void ParametricEqualizer::setBandCoeffs(unsigned int band, unsigned int numRampSamples)
+{
+    std::array<float, DSP::Biquad::CoeffsPerSection> coeffs;
+    std::copy_n(bandCoeffs.begin() + band * DSP::Biquad::CoeffsPerSection, DSP::Biquad::CoeffsPerSection, coeffs.begin());
+    biquad.setSectionCoeffs(coeffs, band, numRampSamples);
+}
+
+void ParametricEqualizer::processSubBlock(unsigned int numChannels, unsigned int numSamples)
+{
+    // A switch waits for the running crossfade to finish
+    const Realization target { getTargetRealization() };
+    if (target != activeRealization && crossfadeSamplesLeft == 0)
+    {
+        clearRealization(target);
+        fadingRealization = activeRealization;
+        activeRealization = target;
+        crossfadeSamplesLeft = RealizationCrossfadeSize;
+    }
+
+    if (crossfadeSamplesLeft == 0)
+    {
+        processRealization(activeRealization, subBlockOutput.data(), numChannels, numSamples);
+        return;
+    }
+
+    // The fading realization goes first, as the output may be the input
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        crossfadeOutput[ch] = crossfadeBuffer.data() + ch * ControlBlockSize;
+
+    processRealization(fadingRealization, crossfadeOutput.data(), numChannels, numSamples);
+    processRealization(activeRealization, subBlockOutput.data(), numChannels, numSamples);
+
+    const unsigned int fadeSamples { std::min(numSamples, crossfadeSamplesLeft) };
+    const float fadeStep { 1.f / static_cast<float>(RealizationCrossfadeSize) };
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        for (unsigned int n = 0; n < fadeSamples; ++n)
+        {
+            const float fadeIn { 1.f - static_cast<float>(crossfadeSamplesLeft - n) * fadeStep };
+            subBlockOutput[ch][n] = crossfadeOutput[ch][n] + fadeIn * (subBlockOutput[ch][n] - crossfadeOutput[ch][n]);
+        }
+    }
+
+    crossfadeSamplesLeft -= fadeSamples;
+}
+
+ParametricEqualizer::Realization ParametricEqualizer::getTargetRealization() const
+{
+    if (!designsCurrent)
+        return Cascade;
+
+    if (realization == LinearPhase && convolver)
+        return LinearPhase;
+
+    if (realization == Parallel && parallelBiquad.isExpansionValid())
+        return Parallel;
+
+    return Cascade;
+}
+
+void ParametricEqualizer::clearRealization(Realization r)
+{
+    switch (r)
+    {
+        case Cascade: biquad.clear(); break;
+        case Parallel: parallelBiquad.clear(); break;
+        case LinearPhase: convolver->clear(); break;
+    }
+}
+
+void ParametricEqualizer::processRealization(Realization r, float* const* output, unsigned int numChannels, unsigned int numSamples)
+{
+    switch (r)
+    {
+        case Cascade: biquad.process(output, subBlockInput.data(), numChannels, numSamples); break;
+        case Parallel: parallelBiquad.process(output, subBlockInput.data(), numChannels, numSamples); break;
+        case LinearPhase: convolver->process(output, subBlockInput.data(), numChannels, numSamples); break;
+    }
+}
+
+bool ParametricEqualizer::designRealizations()
+{
+    snapshotPendingBands(designBands);
+    calculateCoeffs(designBands.data(), static_cast<unsigned int>(designBands.size()), pendingSampleRate.load(std::memory_order_relaxed), designBandCoeffs.data());
+
+    std::array<float, DSP::Biquad::CoeffsPerSection> coeffs;
+    for (unsigned int b = 0; b < designBands.size(); ++b)
+    {
+        std::copy_n(designBandCoeffs.begin() + b * DSP::Biquad::CoeffsPerSection, DSP::Biquad::CoeffsPerSection, coeffs.begin());
+        parallelBiquad.setSectionCoeffs(coeffs, b);
+    }
+
+    const bool parallelTaken { parallelBiquad.updateExpansion() };
+    const bool firTaken { !convolver || designLinearPhase() };
+    return parallelTaken && firTaken;
+}
+
+bool ParametricEqualizer::designLinearPhase()
+{
+    // Magnitude response of the cascade with zero phase
+    const unsigned int fftSize { firFft->getSize() };
+    for (unsigned int k = 0; k < firFft->getNumBins(); ++k)
+    {
+        const std::complex<double> w { std::polar(1.0, -2.0 * M_PI * static_cast<double>(k) / static_cast<double>(fftSize)) };
+
+        double magnitude { 1.0 };
+        for (unsigned int b = 0; b < designBands.size(); ++b)
+        {
+            const float* c { designBandCoeffs.data() + b * DSP::Biquad::CoeffsPerSection };
+            const std::complex<double> num { static_cast<double>(c[0]) + w * (static_cast<double>(c[1]) + w * static_cast<double>(c[2])) };
+            const std::complex<double> den { 1.0 + w * (static_cast<double>(c[3]) + w * static_cast<double>(c[4])) };
+            magnitude *= std::abs(num) / std::abs(den);
+        }
+
+        firSpectrumReal[k] = static_cast<float>(magnitude);
+    }
+
+    firFft->inverse(firSpectrumReal.data(), firSpectrumImag.data(), firImpulse.data());
+
+    // Center the circular zero phase impulse and taper it with a Blackman window
+    const unsigned int halfLength { firLength / 2 };
+    for (unsigned int n = 0; n < firLength; ++n)
     {
-        bands[band].gain = gain;
-        biquad.setSectionCoeffs(calculateCoeffs(bands[band]), band);
+        const double phase { 2.0 * M_PI * static_cast<double>(n) / static_cast<double>(firLength - 1u) };
+        const double window { 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase) };
+        fir[n] = static_cast<float>(window) * firImpulse[(n + fftSize - halfLength) % fftSize];
     }
+
+    return convolver->setFilter(fir.data(), firLength);
+}
+
+void ParametricEqualizer::requestDesign()
+{
+    if (designsWanted.load(std::memory_order_acquire) && !designRequested.exchange(true, std::memory_order_acq_rel))
+        Designer::get().request();
+}
+
+void ParametricEqualizer::runDesign()
+{
+    std::lock_guard<std::mutex> lock { designLock };
+    if (designDirty.exchange(false, std::memory_order_acquire))
+        handOverDesigns();
 }
 
-std::array<float, DSP::Biquad::CoeffsPerSection> ParametricEqualizer::calculateCoeffs(const Band& band)
+void ParametricEqualizer::handOverDesigns()
+{
+    if (designRealizations())
+    {
+        designCount.fetch_add(1, std::memory_order_release);
+        return;
+    }
+
+    designDirty.store(true, std::memory_order_release);
+    designRetry.store(true, std::memory_order_release);
+}
+
+std::array<float, DSP::Biquad::CoeffsPerSection> ParametricEqualizer::calculateCoeffs(const Band& band, double sampleRate)
 {
     // Flat coeffs
     std::array<float, DSP::Biquad::CoeffsPerSection> coeffs { 1.f, 0.f, 0.f, 0.f, 0.f };
@@ -165,10 +696,113 @@ std::array<float, DSP::Biquad::CoeffsPerSection> ParametricEqualizer::calculateC
         }
         break;
 
+        case BandPass:
+        {
+            float peakGain = std::pow(10.f, band.gain * 0.05f);
+            float omega = (2.f * static_cast<float>(M_PI) * band.freq) / static_cast<float>(sampleRate);
+            float alpha = std::sin(omega) / (band.reso * 2.f);
+
+            float a0 = 1.f / (1.f + alpha);
+            coeffs = { peakGain * alpha * a0, 0.f, -peakGain * alpha * a0, -2.f * std::cos(omega) * a0, (1.f - alpha) * a0 };
+        }
+        break;
+
         default: break;
     }
 
     return coeffs;
 }
 
+void ParametricEqualizer::calculateCoeffs(const Band* bands, unsigned int numBands, double sampleRate, float* coeffs)
+{
+    using Simd::Float4;
+
+    // Every band type is the bilinear transform of an analog prototype
+    // (pb2 s^2 + pb1 s + pb0) / (pa2 s^2 + pa1 s + pa0) with K = tan(pi f / fs),
+    // written this way all types share one tan and one exp2 per band and
+    // the type only selects the prototype coeffs
+    const float piOverSampleRate { static_cast<float>(M_PI / std::fmax(sampleRate, 1.0)) };
+    const Float4 log2Of10Over80 { Float4::broadcast(0.0415241012f) };
+    const Float4 zero { Float4::broadcast(0.f) };
+    const Float4 one { Float4::broadcast(1.f) };
+    const Float4 two { Float4::broadcast(2.f) };
+
+    // Bands are designed in chunks, gathered into lanes first so the
+    // vector loop over the chunk has no dependencies between iterations
+    constexpr unsigned int ChunkSize { 8 * Simd::Lanes };
+    float type[ChunkSize];
+    float halfOmega[ChunkSize];
+    float reso[ChunkSize];
+    float gain[ChunkSize];
+    float designed[DSP::Biquad::CoeffsPerSection][ChunkSize];
+
+    for (unsigned int chunk = 0; chunk < numBands; chunk += ChunkSize)
+    {
+        const unsigned int chunkBands { std::min(numBands - chunk, ChunkSize) };
+        const unsigned int paddedChunkBands { (chunkBands + Simd::Lanes - 1u) / Simd::Lanes * Simd::Lanes };
+
+        // Padding lanes design a flat band
+        for (unsigned int b = 0; b < paddedChunkBands; ++b)
+        {
+            const Band padding {};
+            const Band& band { b < chunkBands ? bands[chunk + b] : padding };
+            type[b] = static_cast<float>(band.type);
+            halfOmega[b] = piOverSampleRate * band.freq;
+            reso[b] = band.reso;
+            gain[b] = band.gain;
+        }
+
+        for (unsigned int b = 0; b < paddedChunkBands; b += Simd::Lanes)
+        {
+            const Float4 types { Float4::load(type + b) };
+            const Float4 K { FastMath::tan(Float4::load(halfOmega + b)) };
+            const Float4 invQ { one / Float4::load(reso + b) };
+            const Float4 sqrtA { FastMath::exp2(Float4::load(gain + b) * log2Of10Over80) };
+            const Float4 A { sqrtA * sqrtA };
+            const Float4 sqrtAOverQ { sqrtA * invQ };
+            const Float4 ASqrtAOverQ { A * sqrtAOverQ };
+
+            auto byType = [&types] (const Float4& highPass, const Float4& lowShelf, const Float4& peak, const Float4& lowPass,
+                                    const Float4& highShelf, const Float4& bandPass)
+            {
+                return Simd::selectEqual(types, Float4::broadcast(HighPass), highPass,
+                       Simd::selectEqual(types, Float4::broadcast(LowShelf), lowShelf,
+                       Simd::selectEqual(types, Float4::broadcast(Peak), peak,
+                       Simd::selectEqual(types, Float4::broadcast(LowPass), lowPass,
+                       Simd::selectEqual(types, Float4::broadcast(HighShelf), highShelf, bandPass)))));
+            };
+
+            const Float4 pb2 { byType(one, A, one, zero, A * A, zero) };
+            const Float4 pb1 { byType(zero, ASqrtAOverQ, A * invQ, zero, ASqrtAOverQ, A * A * invQ) };
+            const Float4 pb0 { byType(zero, A * A, one, one, A, zero) };
+            const Float4 pa2 { byType(one, A, one, one, one, one) };
+            const Float4 pa1 { byType(invQ, sqrtAOverQ, invQ / A, invQ, sqrtAOverQ, invQ) };
+            const Float4 pa0 { byType(one, one, one, one, A, one) };
+
+            // s = (1 - z^-1) / (K (1 + z^-1)), multiplied thru by K^2 (1 + z^-1)^2
+            const Float4 K2 { K * K };
+            const Float4 n0 { pb2 + pb1 * K + pb0 * K2 };
+            const Float4 n1 { two * (pb0 * K2 - pb2) };
+            const Float4 n2 { pb2 - pb1 * K + pb0 * K2 };
+            const Float4 d0 { pa2 + pa1 * K + pa0 * K2 };
+            const Float4 d1 { two * (pa0 * K2 - pa2) };
+            const Float4 d2 { pa2 - pa1 * K + pa0 * K2 };
+
+            // The transform of a constant prototype would cancel a double pole on the unit circle,
+            // so flat bands are set to the identity directly
+            const Float4 flat { Float4::broadcast(Flat) };
+            const Float4 invD0 { one / d0 };
+            Simd::selectEqual(types, flat, one, n0 * invD0).store(designed[0] + b);
+            Simd::selectEqual(types, flat, zero, n1 * invD0).store(designed[1] + b);
+            Simd::selectEqual(types, flat, zero, n2 * invD0).store(designed[2] + b);
+            Simd::selectEqual(types, flat, zero, d1 * invD0).store(designed[3] + b);
+            Simd::selectEqual(types, flat, zero, d2 * invD0).store(designed[4] + b);
+        }
+
+        for (unsigned int b = 0; b < chunkBands; ++b)
+            for (unsigned int c = 0; c < DSP::Biquad::CoeffsPerSection; ++c)
+                coeffs[(chunk + b) * DSP::Biquad::CoeffsPerSection + c] = designed[c][b];
+    }
+}
+
 }
\ No newline at end of file
@@ -1,6 +1,13 @@
 #pragma once
 
 #include "Biquad.h"
+#include "Fft.h"
+#include "ParallelBiquad.h"
+#include "PartitionedConvolver.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 namespace DSP
 {
@@ -15,13 +22,34 @@ public:
         LowShelf,
         Peak,
         LowPass,
-        HighShelf
+        HighShelf,
+        BandPass
+    };
+
+    // How the bands are realized
+    //  - Cascade: one biquad section per band in series
+    //  - Parallel: partial fraction expansion of the cascade, all sections
+    //    run side by side and are summed. The expansion is calculated by the
+    //    designer and ramped in. Falls back to Cascade while the
+    //    current band settings cannot be expanded (e.g. two identical bands)
+    //  - LinearPhase: symmetric FIR with the magnitude response of the cascade,
+    //    run thru a partitioned FFT convolver. Adds getLinearPhaseLatency samples
+    //    of latency and falls back to Cascade until prepareLinearPhase is called
+    // Switching realization, fallbacks included, crossfades the outgoing realization
+    // into the incoming one over RealizationCrossfadeSize samples. The incoming one
+    // starts from cleared states, so LinearPhase fades in after its latency
+    enum Realization : unsigned int
+    {
+        Cascade = 0,
+        Parallel,
+        LinearPhase
     };
 
     // Main ctor
     // Requires number of bands and channels to be allocated
     // The number of bands cannot be modified later but channels can be reallocated
     // All bands filters will be initialised to Flat
+    // Not realtime safe, registers with the designer shared by all equalizers
     ParametricEqualizer(unsigned int numOfBands, unsigned int maxNumChannels = 2);
 
     // Dtor
@@ -44,6 +72,17 @@ public:
     // Clear states, recalculate coeffs to new sample rate and reallocate channels
     void prepare(double sampleRate, unsigned int maxNumChannels);
 
+    // Allocate the linear phase realization
+    // firLength is rounded up to an odd number so the FIR delay is a whole number of samples,
+    // blockSize is the convolver partition size and must be a power of two
+    // The first FIR is designed before returning, later ones by the designer
+    // whenever a band or the sample rate changes, and crossfaded in by process
+    // Not realtime safe, must not be called concurrently with process
+    void prepareLinearPhase(unsigned int firLength, unsigned int blockSize);
+
+    // Latency of the LinearPhase realization in samples, 0 if it was not prepared
+    unsigned int getLinearPhaseLatency() const;
+
     // Process audio buffers
     // This method can be called with a lower number of channels than allocated
     void process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples);
@@ -52,6 +91,16 @@ public:
     // Single sample flavour
     void process(float* output, const float* input, unsigned int numChannels);
 
+    // Band changes are picked up by the audio thread once every ControlBlockSize
+    // samples and the coefficients are interpolated across the next sub-block
+    static constexpr unsigned int ControlBlockSize { 32 };
+
+    // Length of the crossfade between realizations
+    static constexpr unsigned int RealizationCrossfadeSize { 8 * ControlBlockSize };
+
+    // The band setters are lock-free and can be called from any thread
+    // The change takes effect at the start of the next control sub-block
+
     // Set filter type of a band
     void setBandType(unsigned int band, FilterType type);
 
@@ -62,14 +111,35 @@ public:
     void setBandResonance(unsigned int band, float resonance);
 
     // Set filter gain of a band in dB
+    // For BandPass this is the gain at the centre frequency
     void setBandGain(unsigned int band, float gain);
 
-private:
-    // Biquad structure for filter realization
-    DSP::Biquad biquad;
+    // Frequency response for editors
+    // Meant for one non audio thread at a time, e.g. the message thread
+    // Evaluated from a lock-free snapshot of the band settings and kept until
+    // a band or the sample rate changes, so idle updates only read an atomic
 
-    // Current sample rate of coefficients
-    double sampleRate { 48000.0 };
+    // Set the frequencies in Hz the response is evaluated at
+    // Allocates, not realtime safe
+    void setResponseFrequencies(const float* frequencies, unsigned int numPoints);
+
+    // Evaluate the magnitude response again if anything changed since the last call
+    // Returns true if the response was updated
+    bool updateResponse();
+
+    // Magnitude response in dB at every response frequency, as of the last updateResponse
+    const std::vector<float>& getMagnitudeResponse() const noexcept { return responseMagnitudes; }
+
+    // Select the filter structure used to realize the bands
+    // Calling this method will clear the states
+    void setTopology(DSP::Biquad::Topology topology);
+
+    // Select how the bands are realized
+    // Takes effect at the start of the next sub-block, crossfaded
+    // Meant for the audio thread, e.g. from a parameter callback
+    // The parallel expansion and the FIR are only kept up to date by the designer once
+    // Parallel or LinearPhase has been selected, until then no designs run at all
+    void setRealization(Realization newRealization);
 
     // Structure to hold band filter information
     struct Band
@@ -80,11 +150,169 @@ private:
         float gain { 0.f };
     };
 
-    // All bands information
+    // Calculate the biquad coefficients of a band at the given sample rate
+    static std::array<float, DSP::Biquad::CoeffsPerSection> calculateCoeffs(const Band& band, double sampleRate);
+
+    // Calculate the biquad coefficients of numBands bands at once
+    // coeffs must hold numBands * Biquad::CoeffsPerSection values, in the same layout as Biquad
+    // Simd::Lanes bands are designed per pass with the FastMath approximations,
+    // the result matches the single band flavour within float precision
+    static void calculateCoeffs(const Band* bands, unsigned int numBands, double sampleRate, float* coeffs);
+
+private:
+    // Biquad structure for filter realization
+    DSP::Biquad biquad;
+
+    // Parallel form of the same bands
+    DSP::ParallelBiquad parallelBiquad;
+
+    // Realization asked for by setRealization
+    Realization realization { Cascade };
+
+    // Realization being rendered and, while crossfading, the one fading out
+    Realization activeRealization { Cascade };
+    Realization fadingRealization { Cascade };
+    unsigned int crossfadeSamplesLeft { 0 };
+
+    // Current sample rate of coefficients
+    double sampleRate { 48000.0 };
+
+    // All bands information, as seen by the audio thread
     std::vector<Band> bands;
 
-    // Helper function to calculate coefficients
-    std::array<float, DSP::Biquad::CoeffsPerSection> calculateCoeffs(const Band & band);
+    // Band settings written by the setters
+    struct PendingBand
+    {
+        std::atomic<FilterType> type { Flat };
+        std::atomic<float> freq { 1000.f };
+        std::atomic<float> reso { 0.7071f };
+        std::atomic<float> gain { 0.f };
+        std::atomic<bool> changed { false };
+    };
+
+    std::vector<PendingBand> pendingBands;
+    std::atomic<bool> anyBandChanged { false };
+
+    // Sample rate as seen by the designer and response threads
+    std::atomic<double> pendingSampleRate { 48000.0 };
+
+    // Bumped on every band or sample rate change
+    std::atomic<unsigned int> settingsVersion { 0 };
+
+    // Samples left in the current control sub-block
+    unsigned int controlSamplesLeft { 0 };
+
+    // Coefficients of all bands, designed in one batch when any band changes
+    std::vector<float> bandCoeffs;
+
+    // Scratch list of the bands changed in the current pull
+    std::vector<unsigned int> changedBands;
+
+    // Channel pointers into the current control sub-block
+    std::vector<float*> subBlockOutput;
+    std::vector<const float*> subBlockInput;
+
+    // Output of the fading realization, ControlBlockSize samples per channel
+    std::vector<float> crossfadeBuffer;
+    std::vector<float*> crossfadeOutput;
+
+    // Linear phase realization, only allocated by prepareLinearPhase
+    std::unique_ptr<DSP::PartitionedConvolver> convolver;
+    unsigned int firLength { 0 };
+
+    // Designer shared by all equalizers, a thread that sleeps until a design is requested
+    class Designer;
+
+    // Designer state
+    //  - designsWanted: set on the first Parallel or LinearPhase selection
+    //  - designDirty: band settings changed since the last design handed over
+    //  - designRequested: this equalizer waits for the designer
+    //  - designRetry: the last design was not picked up, requested again once the audio thread took the previous one
+    //  - designCount: designs handed over to the audio thread
+    std::atomic<bool> designsWanted { false };
+    std::atomic<bool> designDirty { false };
+    std::atomic<bool> designRequested { false };
+    std::atomic<bool> designRetry { false };
+    std::atomic<unsigned int> designCount { 0 };
+
+    // Held while designing, so prepare and the designer never touch the realizations at once
+    std::mutex designLock;
+
+    // Audio thread side, false from the first Parallel or LinearPhase selection until the
+    // designs are current, the Cascade realization renders meanwhile
+    bool designsCurrent { true };
+    unsigned int awaitedDesignCount { 0 };
+
+    // Designer scratch, only touched while holding designLock
+    std::vector<Band> designBands;
+    std::vector<float> designBandCoeffs;
+    std::unique_ptr<DSP::Fft> firFft;
+    std::vector<float> firSpectrumReal;
+    std::vector<float> firSpectrumImag;
+    std::vector<float> firImpulse;
+    std::vector<float> fir;
+
+    // A new parallel expansion is ramped in over ParallelRampMs,
+    // so it moves about as steadily as the cascade does
+    static constexpr unsigned int ParallelRampMs { 10 };
+    unsigned int parallelRampSamples { 0 };
+
+    // Response evaluator state, only touched by the thread updating the response
+    // Frequencies and their sin^2(pi f / fs) are padded to a multiple of Simd::Lanes
+    std::vector<float> responseFrequencies;
+    std::vector<float> responsePhi;
+    std::vector<float> responseMagnitudes;
+    std::vector<float> responseSquared;
+    std::vector<Band> responseBands;
+    std::vector<float> responseBandCoeffs;
+    std::vector<float> responseTerms;
+    static const unsigned int ResponseTermsPerBand { 6 };
+    double responseSampleRate { 0.0 };
+    unsigned int responseVersion { 0 };
+    bool responseValid { false };
+
+    // Flag a pending band change to the audio thread
+    void markBandChanged(unsigned int band);
+
+    // Copy the pending band settings, readable from any thread
+    void snapshotPendingBands(std::vector<Band>& snapshot) const;
+
+    // Design the parallel expansion and, if prepared, the FIR from the pending band settings
+    // Returns false if either was not picked up by the audio thread yet
+    bool designRealizations();
+
+    // Design the FIR from the designer band coefficients and hand it to the convolver
+    // Returns false if the convolver has not picked up the previous FIR yet
+    bool designLinearPhase();
+
+    // Ask the designer for a design, if designs are wanted and none is requested yet
+    void requestDesign();
+
+    // Design if anything changed, called by the designer
+    void runDesign();
+
+    // Design the realizations and count them, a design the audio thread could not take yet
+    // is flagged dirty and redone once it took the previous one
+    // Must hold designLock
+    void handOverDesigns();
+
+    // Copy changed pending bands and update their coefficients,
+    // ramping the cascade coefficients over numRampSamples,
+    // and take a new parallel expansion if there is one
+    void pullBandChanges(unsigned int numRampSamples);
+
+    // Set the designed coefficients of a band to the cascade
+    void setBandCoeffs(unsigned int band, unsigned int numRampSamples);
+
+    // Run the realizations over the sub-block channel pointers, crossfading on a switch
+    void processSubBlock(unsigned int numChannels, unsigned int numSamples);
+
+    // Realization that should render, the requested one unless it cannot run right now
+    Realization getTargetRealization() const;
+
+    // Clear and run one realization
+    void clearRealization(Realization r);
+    void processRealization(Realization r, float* const* output, unsigned int numChannels, unsigned int numSamples);
 };
 
 }
\ No newline at end of file
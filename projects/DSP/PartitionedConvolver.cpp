@@ -0,0 +1,185 @@
+#include "PartitionedConvolver.h"
+#include "Simd.h"
+
+#include <algorithm>
+
+namespace DSP
+{
+
+PartitionedConvolver::PartitionedConvolver(unsigned int blockSize_, unsigned int maxFilterLength, unsigned int maxNumChannels) :
+    blockSize { blockSize_ },
+    numPartitions { std::max((maxFilterLength + blockSize_ - 1u) / blockSize_, 1u) },
+    allocatedChannels { maxNumChannels },
+    paddedBins { (blockSize_ + 1u + Simd::Lanes - 1u) / Simd::Lanes * Simd::Lanes },
+    fft(2u * blockSize_),
+    filterFft(2u * blockSize_),
+    filterSpectra(2u * numPartitions * 2u * paddedBins, 0.f),
+    accumulatorReal(paddedBins, 0.f),
+    accumulatorImag(paddedBins, 0.f),
+    timeScratch(2u * blockSize_, 0.f),
+    crossfadeScratch(blockSize_, 0.f),
+    filterScratch(2u * blockSize_, 0.f)
+{
+    reallocateChannels(maxNumChannels);
+}
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+}
+
+void PartitionedConvolver::clear()
+{
+    std::fill(inputSpectra.begin(), inputSpectra.end(), 0.f);
+    std::fill(inputWindows.begin(), inputWindows.end(), 0.f);
+    std::fill(outputBlocks.begin(), outputBlocks.end(), 0.f);
+    spectrumHead = 0;
+    blockPosition = 0;
+}
+
+void PartitionedConvolver::reallocateChannels(unsigned int maxNumChannels)
+{
+    allocatedChannels = maxNumChannels;
+    inputSpectra.resize(allocatedChannels * numPartitions * 2u * paddedBins);
+    inputWindows.resize(allocatedChannels * 2u * blockSize);
+    outputBlocks.resize(allocatedChannels * blockSize);
+    clear();
+}
+
+bool PartitionedConvolver::setFilter(const float* impulseResponse, unsigned int length)
+{
+    // The slot that is not active is free once the previous filter has been crossfaded in
+    if (pendingSlot.load(std::memory_order_acquire) >= 0)
+        return false;
+
+    const unsigned int slot { 1u - publishedActiveSlot.load(std::memory_order_acquire) };
+    length = std::min(length, numPartitions * blockSize);
+
+    for (unsigned int p = 0; p < numPartitions; ++p)
+    {
+        // Zero padded partition, the second half stays zero
+        std::fill(filterScratch.begin(), filterScratch.end(), 0.f);
+        const unsigned int start { p * blockSize };
+        if (start < length)
+            std::copy(impulseResponse + start, impulseResponse + std::min(start + blockSize, length), filterScratch.begin());
+
+        float* spectrum { getFilterSpectrum(slot, p) };
+        filterFft.forward(filterScratch.data(), spectrum, spectrum + paddedBins);
+    }
+
+    pendingSlot.store(static_cast<int>(slot), std::memory_order_release);
+    return true;
+}
+
+void PartitionedConvolver::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    numChannels = std::min(numChannels, allocatedChannels);
+
+    unsigned int n { 0 };
+    while (n < numSamples)
+    {
+        const unsigned int numToCopy { std::min(numSamples - n, blockSize - blockPosition) };
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+        {
+            // Input is read before output is written, so processing can be in place
+            float* window { inputWindows.data() + ch * 2u * blockSize };
+            std::copy(input[ch] + n, input[ch] + n + numToCopy, window + blockSize + blockPosition);
+
+            const float* block { outputBlocks.data() + ch * blockSize };
+            std::copy(block + blockPosition, block + blockPosition + numToCopy, output[ch] + n);
+        }
+
+        n += numToCopy;
+        blockPosition += numToCopy;
+
+        if (blockPosition == blockSize)
+        {
+            processBlock(numChannels);
+            blockPosition = 0;
+        }
+    }
+}
+
+float* PartitionedConvolver::getFilterSpectrum(unsigned int slot, unsigned int partition)
+{
+    return filterSpectra.data() + (slot * numPartitions + partition) * 2u * paddedBins;
+}
+
+float* PartitionedConvolver::getInputSpectrum(unsigned int channel, unsigned int block)
+{
+    return inputSpectra.data() + (channel * numPartitions + block) * 2u * paddedBins;
+}
+
+void PartitionedConvolver::processBlock(unsigned int numChannels)
+{
+    const int newSlot { pendingSlot.load(std::memory_order_acquire) };
+
+    spectrumHead = (spectrumHead + 1u) % numPartitions;
+
+    for (unsigned int ch = 0; ch < allocatedChannels; ++ch)
+    {
+        float* window { inputWindows.data() + ch * 2u * blockSize };
+        float* spectrum { getInputSpectrum(ch, spectrumHead) };
+
+        // Channels that are not processed keep a silent history
+        if (ch >= numChannels)
+        {
+            std::fill(spectrum, spectrum + 2u * paddedBins, 0.f);
+            continue;
+        }
+
+        fft.forward(window, spectrum, spectrum + paddedBins);
+        std::copy(window + blockSize, window + 2u * blockSize, window);
+
+        float* block { outputBlocks.data() + ch * blockSize };
+        convolve(ch, activeSlot, block);
+
+        if (newSlot >= 0)
+        {
+            convolve(ch, static_cast<unsigned int>(newSlot), crossfadeScratch.data());
+
+            const float step { 1.f / static_cast<float>(blockSize) };
+            for (unsigned int i = 0; i < blockSize; ++i)
+            {
+                const float fadeIn { (static_cast<float>(i) + 0.5f) * step };
+                block[i] += fadeIn * (crossfadeScratch[i] - block[i]);
+            }
+        }
+    }
+
+    if (newSlot >= 0)
+    {
+        activeSlot = static_cast<unsigned int>(newSlot);
+        publishedActiveSlot.store(activeSlot, std::memory_order_release);
+        pendingSlot.store(-1, std::memory_order_release);
+    }
+}
+
+void PartitionedConvolver::convolve(unsigned int channel, unsigned int slot, float* output)
+{
+    std::fill(accumulatorReal.begin(), accumulatorReal.end(), 0.f);
+    std::fill(accumulatorImag.begin(), accumulatorImag.end(), 0.f);
+
+    // Newest input block with the first partition, older blocks with later partitions
+    for (unsigned int p = 0; p < numPartitions; ++p)
+    {
+        const float* x { getInputSpectrum(channel, (spectrumHead + numPartitions - p) % numPartitions) };
+        const float* h { getFilterSpectrum(slot, p) };
+
+        for (unsigned int k = 0; k < paddedBins; k += Simd::Lanes)
+        {
+            const Simd::Float4 xr { Simd::Float4::load(x + k) };
+            const Simd::Float4 xi { Simd::Float4::load(x + paddedBins + k) };
+            const Simd::Float4 hr { Simd::Float4::load(h + k) };
+            const Simd::Float4 hi { Simd::Float4::load(h + paddedBins + k) };
+
+            (Simd::Float4::load(accumulatorReal.data() + k) + xr * hr - xi * hi).store(accumulatorReal.data() + k);
+            (Simd::Float4::load(accumulatorImag.data() + k) + xr * hi + xi * hr).store(accumulatorImag.data() + k);
+        }
+    }
+
+    // Overlap-save, the first half of the circular convolution is aliased
+    fft.inverse(accumulatorReal.data(), accumulatorImag.data(), timeScratch.data());
+    std::copy(timeScratch.begin() + blockSize, timeScratch.end(), output);
+}
+
+}
\ No newline at end of file
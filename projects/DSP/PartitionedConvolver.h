@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Fft.h"
+
+#include <atomic>
+#include <vector>
+
+namespace DSP
+{
+
+// Uniformly partitioned overlap-save FFT convolution
+// The filter is split in partitions of blockSize samples, each input block is
+// transformed once and multiplied with all partitions thru a frequency domain
+// delay line, so the cost per sample only grows with the number of partitions
+// Adds blockSize samples of latency
+// A new filter is transformed by the thread calling setFilter and crossfaded
+// in by the audio thread over one block
+class PartitionedConvolver
+{
+public:
+    // blockSize must be a power of two
+    PartitionedConvolver(unsigned int blockSize, unsigned int maxFilterLength, unsigned int maxNumChannels);
+    ~PartitionedConvolver();
+
+    // No default ctor
+    PartitionedConvolver() = delete;
+
+    // No copy semantics
+    PartitionedConvolver(const PartitionedConvolver&) = delete;
+    const PartitionedConvolver& operator=(const PartitionedConvolver&) = delete;
+
+    // No move semantics
+    PartitionedConvolver(PartitionedConvolver&&) = delete;
+    const PartitionedConvolver& operator=(PartitionedConvolver&&) = delete;
+
+    // Clear all states, the filter is kept
+    void clear();
+
+    // Reallocate state storage
+    // Calling this method will clear the states
+    void reallocateChannels(unsigned int maxNumChannels);
+
+    // Set a new filter, longer filters are truncated to maxFilterLength
+    // Lock-free, must only be called from one thread at a time besides the audio thread
+    // Returns false if the previous filter has not been picked up by process yet
+    bool setFilter(const float* impulseResponse, unsigned int length);
+
+    // Whether a filter handed over by setFilter waits for process, setFilter fails until it is taken
+    bool isFilterPending() const noexcept { return pendingSlot.load(std::memory_order_acquire) >= 0; }
+
+    // Process audio
+    // This method can be called with a lower number of channels than allocated
+    // and any number of samples
+    void process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples);
+
+    unsigned int getLatency() const noexcept { return blockSize; }
+    unsigned int getAllocatedChannels() const noexcept { return allocatedChannels; }
+
+private:
+    unsigned int blockSize { 0 };
+    unsigned int numPartitions { 0 };
+    unsigned int allocatedChannels { 0 };
+
+    // bins of a 2 * blockSize real FFT rounded up to a multiple of Simd::Lanes
+    unsigned int paddedBins { 0 };
+
+    // Used by the audio thread and by setFilter respectively
+    Fft fft;
+    Fft filterFft;
+
+    // Two filter slots, the active one and the one being prepared or crossfaded in
+    // [slot0_part0_real, slot0_part0_imag, slot0_part1_real, ... , slot1_part0_real, ...]
+    std::vector<float> filterSpectra;
+    unsigned int activeSlot { 0 };
+    std::atomic<unsigned int> publishedActiveSlot { 0 };
+    std::atomic<int> pendingSlot { -1 };
+
+    // Spectra of the last numPartitions input blocks of every channel, a ring indexed by spectrumHead
+    // [ch0_block0_real, ch0_block0_imag, ch0_block1_real, ... , ch1_block0_real, ...]
+    std::vector<float> inputSpectra;
+    unsigned int spectrumHead { 0 };
+
+    // Last two input blocks of every channel
+    std::vector<float> inputWindows;
+
+    // Output of the last block of every channel, played while the next block is collected
+    std::vector<float> outputBlocks;
+    unsigned int blockPosition { 0 };
+
+    // Audio thread scratch
+    std::vector<float> accumulatorReal;
+    std::vector<float> accumulatorImag;
+    std::vector<float> timeScratch;
+    std::vector<float> crossfadeScratch;
+
+    // setFilter scratch
+    std::vector<float> filterScratch;
+
+    float* getFilterSpectrum(unsigned int slot, unsigned int partition);
+    float* getInputSpectrum(unsigned int channel, unsigned int block);
+
+    // Transform the collected block of all channels and compute their next output block
+    void processBlock(unsigned int numChannels);
+
+    // Multiply the input spectra of a channel with all partitions of a filter slot,
+    // the last blockSize samples of the result are left in output
+    void convolve(unsigned int channel, unsigned int slot, float* output);
+};
+
+}
\ No newline at end of file
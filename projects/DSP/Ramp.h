@@ -1,10 +1,18 @@
 #pragma once
 
+#include "Simd.h"
+
+#include <algorithm>
 #include <cmath>
+#include <type_traits>
 
 namespace DSP
 {
 
+// Linear ramp towards a target value
+// setTarget works out how many samples are left in the active segment, so the block
+// flavours run the segment as a vectorized linear ramp and the rest of the block as a
+// constant, skipped entirely when it would not change the audio
 template<typename F>
 class Ramp
 {
@@ -54,6 +62,8 @@ public:
 
         if (skipRamp)
             currentValue = targetValue = newTargetValue;
+
+        updateRampSamples();
     }
 
     // Set new ramp time
@@ -65,11 +75,7 @@ public:
     // Apply summing ramp to a single sample in-place
     void applySum(F* buffers, unsigned int numChannels)
     {
-        const F targetDelta { std::fabs(targetValue - currentValue) };
-        if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-            currentValue += rampStep;
-        else
-            currentValue = targetValue;
+        advance();
 
         for (unsigned int ch = 0; ch < numChannels; ++ch)
             buffers[ch] += currentValue;
@@ -78,43 +84,23 @@ public:
     // Apply summing ramp to an audio buffer in-place
     void applySum(F* const* buffers, unsigned int numChannels, unsigned int numSamples)
     {
-        for (unsigned int n = 0; n < numSamples; ++n)
-        {
-            const F targetDelta { std::fabs(targetValue - currentValue) };
-            if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-                currentValue += rampStep;
-            else
-                currentValue = targetValue;
-
-            for (unsigned int ch = 0; ch < numChannels; ++ch)
-                buffers[ch][n] += currentValue;
-        }
+        applySum(buffers, buffers, numChannels, numSamples);
     }
 
     // Apply summing ramp to an audio buffer out-of-place
     void applySum(F* const* output, const F* const* input, unsigned int numChannels, unsigned int numSamples)
     {
-        for (unsigned int n = 0; n < numSamples; ++n)
-        {
-            const F targetDelta { std::fabs(targetValue - currentValue) };
-            if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-                currentValue += rampStep;
-            else
-                currentValue = targetValue;
+        const unsigned int rampLength { processRamp<Sum>(output, input, numChannels, numSamples) };
 
-            for (unsigned int ch = 0; ch < numChannels; ++ch)
-                output[ch][n] = currentValue + input[ch][n];
-        }
+        // Adding zero in-place is a no-op
+        if (rampLength < numSamples && (targetValue != static_cast<F>(0) || output != input))
+            applyConstant<Sum>(output, input, numChannels, rampLength, numSamples, targetValue);
     }
 
     // Apply gain ramp to an audio buffer in-place for single sample
     void applyGain(F* buffers, unsigned int numChannels)
     {
-        const F targetDelta { std::fabs(targetValue - currentValue) };
-        if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-            currentValue += rampStep;
-        else
-            currentValue = targetValue;
+        advance();
 
         for (unsigned int ch = 0; ch < numChannels; ++ch)
             buffers[ch] *= currentValue;
@@ -123,43 +109,22 @@ public:
     // Apply gain ramp to an audio buffer in-place
     void applyGain(F* const* buffers, unsigned int numChannels, unsigned int numSamples)
     {
-        for (unsigned int n = 0; n < numSamples; ++n)
-        {
-            const F targetDelta { std::fabs(targetValue - currentValue) };
-            if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-                currentValue += rampStep;
-            else
-                currentValue = targetValue;
-
-            for (unsigned int ch = 0; ch < numChannels; ++ch)
-                buffers[ch][n] *= currentValue;
-        }
+        applyGain(buffers, buffers, numChannels, numSamples);
     }
 
     // Apply gain ramp to an audio buffer out-of-place
     void applyGain(F* const* output, const F* const* input, unsigned int numChannels, unsigned int numSamples)
     {
-        for (unsigned int n = 0; n < numSamples; ++n)
-        {
-            const F targetDelta{ std::fabs(targetValue - currentValue) };
-            if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-                currentValue += rampStep;
-            else
-                currentValue = targetValue;
+        const unsigned int rampLength { processRamp<Gain>(output, input, numChannels, numSamples) };
 
-            for (unsigned int ch = 0; ch < numChannels; ++ch)
-                output[ch][n] = currentValue * input[ch][n];
-        }
+        // Unity gain in-place is a no-op
+        if (rampLength < numSamples && (targetValue != static_cast<F>(1) || output != input))
+            applyConstant<Gain>(output, input, numChannels, rampLength, numSamples, targetValue);
     }
 
     float getNext()
     {
-        const F targetDelta { std::fabs(targetValue - currentValue) };
-        if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-            currentValue += rampStep;
-        else
-            currentValue = targetValue;
-
+        advance();
         return currentValue;
     }
 
@@ -170,11 +135,137 @@ public:
     static constexpr F minDelta { static_cast<F>(1e-9) };
 
 private:
+    enum Operation : unsigned int
+    {
+        Gain = 0,
+        Sum
+    };
+
     double sampleRate { 48000.0 };
     F rampTime;
     F rampStep { static_cast<F>(0) };
     F targetValue { static_cast<F>(0) };
     F currentValue { static_cast<F>(0) };
+
+    // Steps left in the active segment, after them the value lands on the target
+    unsigned int rampSamples { 0 };
+
+    // A fresh ramp is a whole number of steps long, the tolerance keeps rounding
+    // of the current value from adding a step
+    static constexpr double RoundingTolerance { 1e-3 };
+
+    // Count the steps while |target - current| > |2 * step|, moving towards the target
+    void updateRampSamples()
+    {
+        const F stepSize { std::fabs(rampStep) };
+        if (stepSize > minDelta)
+        {
+            const double steps { std::ceil(static_cast<double>(std::fabs(targetValue - currentValue)) / stepSize - 2.0 - RoundingTolerance) };
+            rampSamples = steps > 0.0 ? static_cast<unsigned int>(std::fmin(steps, 4294967295.0)) : 0u;
+        }
+        else
+        {
+            rampSamples = 0;
+        }
+    }
+
+    // Advance the value by one sample
+    void advance()
+    {
+        if (rampSamples > 0)
+        {
+            currentValue += rampStep;
+            --rampSamples;
+        }
+        else
+        {
+            currentValue = targetValue;
+        }
+    }
+
+    // Apply what is left of the active segment, up to numSamples samples
+    // Values are start + (n + 1) * step, so they do not accumulate rounding errors
+    // return the number of samples processed
+    template<Operation op>
+    unsigned int processRamp(F* const* output, const F* const* input, unsigned int numChannels, unsigned int numSamples)
+    {
+        const unsigned int rampLength { std::min(numSamples, rampSamples) };
+        if (rampLength == 0)
+        {
+            if (numSamples > 0)
+                currentValue = targetValue;
+
+            return 0;
+        }
+
+        unsigned int vectorSamples { 0 };
+        if constexpr (std::is_same<F, float>::value)
+        {
+            using Simd::Float4;
+
+            vectorSamples = rampLength / Simd::Lanes * Simd::Lanes;
+
+            const Float4 start { Float4::broadcast(currentValue) };
+            const Float4 step { Float4::broadcast(rampStep) };
+            const Float4 lanes { Float4::broadcast(static_cast<float>(Simd::Lanes)) };
+            for (unsigned int ch = 0; ch < numChannels; ++ch)
+            {
+                Float4 index { Float4::set(1.f, 2.f, 3.f, 4.f) };
+                for (unsigned int n = 0; n < vectorSamples; n += Simd::Lanes)
+                {
+                    const Float4 value { start + index * step };
+                    const Float4 x { Float4::load(input[ch] + n) };
+                    (op == Gain ? x * value : x + value).store(output[ch] + n);
+                    index = index + lanes;
+                }
+            }
+        }
+
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+        {
+            for (unsigned int n = vectorSamples; n < rampLength; ++n)
+            {
+                const F value { currentValue + static_cast<F>(n + 1) * rampStep };
+                output[ch][n] = op == Gain ? input[ch][n] * value : input[ch][n] + value;
+            }
+        }
+
+        currentValue += static_cast<F>(rampLength) * rampStep;
+        rampSamples -= rampLength;
+
+        // The sample after the segment lands on the target
+        if (rampLength < numSamples)
+            currentValue = targetValue;
+
+        return rampLength;
+    }
+
+    // Apply a settled value to samples from begin to end
+    template<Operation op>
+    static void applyConstant(F* const* output, const F* const* input, unsigned int numChannels, unsigned int begin, unsigned int end, F value)
+    {
+        unsigned int vectorEnd { begin };
+        if constexpr (std::is_same<F, float>::value)
+        {
+            using Simd::Float4;
+
+            vectorEnd = begin + (end - begin) / Simd::Lanes * Simd::Lanes;
+
+            const Float4 constant { Float4::broadcast(value) };
+            for (unsigned int ch = 0; ch < numChannels; ++ch)
+            {
+                for (unsigned int n = begin; n < vectorEnd; n += Simd::Lanes)
+                {
+                    const Float4 x { Float4::load(input[ch] + n) };
+                    (op == Gain ? x * constant : x + constant).store(output[ch] + n);
+                }
+            }
+        }
+
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+            for (unsigned int n = vectorEnd; n < end; ++n)
+                output[ch][n] = op == Gain ? input[ch][n] * value : input[ch][n] + value;
+    }
 };
 
 }
\ No newline at end of file
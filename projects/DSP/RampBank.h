@@ -0,0 +1,165 @@
+#pragma once
+
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace DSP
+{
+
+// Bank of N linear ramps sharing one ramp time, stored as structure of arrays
+// Every ramp steps like Ramp<float> and renders into its own row of control values,
+// a ramp that settled and already filled its row with the target is skipped thru a bitmask
+template<unsigned int N>
+class RampBank
+{
+public:
+    static_assert(N > 0 && N <= 32, "RampBank tracks its ramps in a 32 bit mask");
+
+    // Longest block rendered at once, sized for the rows
+    static constexpr unsigned int MaxBlockSize { 64 };
+
+    // Default ramp time of 50ms
+    static constexpr float DefaultRampTime { 0.05f };
+
+    // Minimum ramp time in secondes
+    static constexpr float minRampTime { 1e-3f };
+
+    // Minimun absolute differente between target and current value
+    static constexpr float minDelta { 1e-9f };
+
+    RampBank(float rampTimeSec) :
+        rampTime { std::fmax(rampTimeSec, minRampTime) }
+    { }
+
+    ~RampBank() { }
+
+    // Default ctor
+    RampBank() :
+        rampTime { DefaultRampTime }
+    { }
+
+    // No copy semantics
+    RampBank(const RampBank&) = delete;
+    const RampBank& operator=(const RampBank&) = delete;
+
+    // No move semantics
+    RampBank(RampBank&&) = delete;
+    const RampBank& operator=(RampBank&&) = delete;
+
+    // Update sample rate of the ramp time, ramps in progress keep their targets
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        for (unsigned int i = 0; i < N; ++i)
+            setTarget(i, targetValues[i]);
+    }
+
+    // Set the target value of a ramp
+    // optionally allowing to skip the ramp
+    void setTarget(unsigned int index, float newTargetValue, bool skipRamp = false)
+    {
+        if (index >= N)
+            return;
+
+        if (std::fabs(newTargetValue - currentValues[index]) > minDelta)
+        {
+            targetValues[index] = newTargetValue;
+            rampSteps[index] = (targetValues[index] - currentValues[index]) / static_cast<float>(sampleRate * rampTime);
+        }
+
+        if (skipRamp)
+            currentValues[index] = targetValues[index] = newTargetValue;
+
+        // Steps while |target - current| > |2 * step|, moving towards the target
+        const float stepSize { std::fabs(rampSteps[index]) };
+        const double steps { std::ceil(static_cast<double>(std::fabs(targetValues[index] - currentValues[index])) / stepSize - 2.0 - RoundingTolerance) };
+        rampSamples[index] = stepSize > minDelta && steps > 0.0 ? static_cast<unsigned int>(std::fmin(steps, 4294967295.0)) : 0u;
+
+        // The row no longer holds the target
+        filledMask &= ~(1u << index);
+    }
+
+    // Set new ramp time, taking effect at the next target
+    void setRampTime(float newRampTimeSec)
+    {
+        rampTime = std::fmax(newRampTimeSec, minRampTime);
+    }
+
+    // Render the next numSamples, up to MaxBlockSize, of every ramp into its row
+    void process(unsigned int numSamples)
+    {
+        using Simd::Float4;
+
+        numSamples = std::min(numSamples, MaxBlockSize);
+        if (numSamples == 0)
+            return;
+
+        for (unsigned int i = 0; i < N; ++i)
+        {
+            if ((filledMask & (1u << i)) != 0)
+                continue;
+
+            float* row { rows[i] };
+            const unsigned int rampLength { std::min(numSamples, rampSamples[i]) };
+
+            // Active segment, values are start + (n + 1) * step, rows hold whole registers
+            const Float4 start { Float4::broadcast(currentValues[i]) };
+            const Float4 step { Float4::broadcast(rampSteps[i]) };
+            const Float4 lanes { Float4::broadcast(static_cast<float>(Simd::Lanes)) };
+            Float4 index { Float4::set(1.f, 2.f, 3.f, 4.f) };
+            for (unsigned int n = 0; n < rampLength; n += Simd::Lanes)
+            {
+                (start + index * step).store(row + n);
+                index = index + lanes;
+            }
+
+            currentValues[i] += static_cast<float>(rampLength) * rampSteps[i];
+            rampSamples[i] -= rampLength;
+            if (rampLength == numSamples)
+                continue;
+
+            // Settled, a row filled from its start holds the target until the next setTarget
+            currentValues[i] = targetValues[i];
+            std::fill(row + rampLength, row + MaxBlockSize, targetValues[i]);
+            if (rampLength == 0)
+                filledMask |= 1u << i;
+        }
+    }
+
+    // return the row of a ramp rendered by the last process call
+    const float* getRow(unsigned int index) const noexcept { return rows[index]; }
+
+    // return the value of a ramp at the end of the last process call
+    float getValue(unsigned int index) const noexcept { return currentValues[index]; }
+
+    // return a mask with a bit set for every ramp that has not reached its target
+    std::uint32_t getActiveMask() const noexcept { return ~filledMask & AllMask; }
+
+private:
+    // A fresh ramp is a whole number of steps long, the tolerance keeps rounding
+    // of the current value from adding a step
+    static constexpr double RoundingTolerance { 1e-3 };
+
+    static constexpr std::uint32_t AllMask { N == 32 ? 0xffffffffu : (1u << (N % 32)) - 1u };
+
+    double sampleRate { 48000.0 };
+    float rampTime;
+
+    float currentValues[N] {};
+    float targetValues[N] {};
+    float rampSteps[N] {};
+
+    // Steps left in the active segment of every ramp
+    unsigned int rampSamples[N] {};
+
+    // Rows whose every sample holds the target
+    std::uint32_t filledMask { 0 };
+
+    // Control values of every ramp, MaxBlockSize samples per row
+    alignas(16) float rows[N][MaxBlockSize] {};
+};
+
+}
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Lfo.h"
+
 namespace DSP
 {
 
@@ -41,10 +43,11 @@ private:
     // modulation type variable
     ModType modType { Sin };
 
-    // Phase state of the oscillators
-    // goes from "0.f" to "2.f * M_PI"
-    float phaseState[2] { 0.f, 0.f };
-    float phaseInc { 0.f };
+    // Quadrature oscillators between L and R channels
+    Lfo lfo;
+
+    // Samples of modulation generated per pass
+    static constexpr unsigned int ChunkSize { 64 };
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,275 @@
+#pragma once
+
+// Minimal 4 lane float vector used by the DSP kernels
+// Maps to SSE2 on x86_64, NEON on arm64 and to a plain array otherwise
+// Define DSP_SIMD_FORCE_SCALAR to force the portable fallback,
+// every operation is element-wise so both paths give identical results
+
+#if !defined(DSP_SIMD_FORCE_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #include <emmintrin.h>
+    #define DSP_SIMD_SSE 1
+#elif !defined(DSP_SIMD_FORCE_SCALAR) && (defined(__aarch64__) || defined(_M_ARM64))
+    #include <arm_neon.h>
+    #define DSP_SIMD_NEON 1
+#else
+    #define DSP_SIMD_SCALAR 1
+#endif
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace DSP
+{
+
+namespace Simd
+{
+
+// Number of float lanes in a register
+static constexpr unsigned int Lanes { 4 };
+
+// Alignment of a register in bytes
+static constexpr unsigned int Alignment { 16 };
+
+struct Float4
+{
+#if DSP_SIMD_SSE
+    __m128 v;
+#elif DSP_SIMD_NEON
+    float32x4_t v;
+#else
+    float v[Lanes];
+#endif
+
+    // Load 4 floats, pointer does not need to be aligned
+    static Float4 load(const float* ptr)
+    {
+#if DSP_SIMD_SSE
+        return { _mm_loadu_ps(ptr) };
+#elif DSP_SIMD_NEON
+        return { vld1q_f32(ptr) };
+#else
+        return { { ptr[0], ptr[1], ptr[2], ptr[3] } };
+#endif
+    }
+
+    // Set all lanes to the same value
+    static Float4 broadcast(float x)
+    {
+#if DSP_SIMD_SSE
+        return { _mm_set1_ps(x) };
+#elif DSP_SIMD_NEON
+        return { vdupq_n_f32(x) };
+#else
+        return { { x, x, x, x } };
+#endif
+    }
+
+    // Set the lanes from 4 values, built in registers so scattered
+    // scalars do not go thru a store and a wide reload
+    static Float4 set(float x0, float x1, float x2, float x3)
+    {
+#if DSP_SIMD_SSE
+        return { _mm_setr_ps(x0, x1, x2, x3) };
+#elif DSP_SIMD_NEON
+        return { vsetq_lane_f32(x3, vsetq_lane_f32(x2, vsetq_lane_f32(x1, vdupq_n_f32(x0), 1), 2), 3) };
+#else
+        return { { x0, x1, x2, x3 } };
+#endif
+    }
+
+    // Store 4 floats, pointer does not need to be aligned
+    void store(float* ptr) const
+    {
+#if DSP_SIMD_SSE
+        _mm_storeu_ps(ptr, v);
+#elif DSP_SIMD_NEON
+        vst1q_f32(ptr, v);
+#else
+        for (unsigned int l = 0; l < Lanes; ++l)
+            ptr[l] = v[l];
+#endif
+    }
+
+    // Horizontal sum of all lanes, added as (v0 + v1) + (v2 + v3)
+    float sum() const
+    {
+#if DSP_SIMD_SSE
+        const __m128 swapped { _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)) };
+        const __m128 pairs { _mm_add_ps(v, swapped) };
+        return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_movehl_ps(swapped, pairs)));
+#elif DSP_SIMD_NEON
+        const float32x2_t pairs { vpadd_f32(vget_low_f32(v), vget_high_f32(v)) };
+        return vget_lane_f32(pairs, 0) + vget_lane_f32(pairs, 1);
+#else
+        return (v[0] + v[1]) + (v[2] + v[3]);
+#endif
+    }
+
+    friend Float4 operator+(const Float4& a, const Float4& b)
+    {
+#if DSP_SIMD_SSE
+        return { _mm_add_ps(a.v, b.v) };
+#elif DSP_SIMD_NEON
+        return { vaddq_f32(a.v, b.v) };
+#else
+        return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } };
+#endif
+    }
+
+    friend Float4 operator-(const Float4& a, const Float4& b)
+    {
+#if DSP_SIMD_SSE
+        return { _mm_sub_ps(a.v, b.v) };
+#elif DSP_SIMD_NEON
+        return { vsubq_f32(a.v, b.v) };
+#else
+        return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } };
+#endif
+    }
+
+    friend Float4 operator*(const Float4& a, const Float4& b)
+    {
+#if DSP_SIMD_SSE
+        return { _mm_mul_ps(a.v, b.v) };
+#elif DSP_SIMD_NEON
+        return { vmulq_f32(a.v, b.v) };
+#else
+        return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } };
+#endif
+    }
+
+    friend Float4 operator/(const Float4& a, const Float4& b)
+    {
+#if DSP_SIMD_SSE
+        return { _mm_div_ps(a.v, b.v) };
+#elif DSP_SIMD_NEON
+        return { vdivq_f32(a.v, b.v) };
+#else
+        return { { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] } };
+#endif
+    }
+};
+
+// Helpers to write a kernel once for a single lane (float) and for Float4
+
+template<typename T> inline T load(const float* ptr);
+template<> inline float load<float>(const float* ptr) { return *ptr; }
+template<> inline Float4 load<Float4>(const float* ptr) { return Float4::load(ptr); }
+
+template<typename T> inline T broadcast(float x);
+template<> inline float broadcast<float>(float x) { return x; }
+template<> inline Float4 broadcast<Float4>(float x) { return Float4::broadcast(x); }
+
+inline void store(float* ptr, float x) { *ptr = x; }
+inline void store(float* ptr, const Float4& x) { x.store(ptr); }
+
+// Element-wise minimum and maximum, the second argument is returned for NaN inputs
+inline float min(float a, float b) { return a < b ? a : b; }
+inline float max(float a, float b) { return a > b ? a : b; }
+
+inline Float4 min(const Float4& a, const Float4& b)
+{
+#if DSP_SIMD_SSE
+    return { _mm_min_ps(a.v, b.v) };
+#elif DSP_SIMD_NEON
+    return { vminq_f32(a.v, b.v) };
+#else
+    return { { min(a.v[0], b.v[0]), min(a.v[1], b.v[1]), min(a.v[2], b.v[2]), min(a.v[3], b.v[3]) } };
+#endif
+}
+
+inline Float4 max(const Float4& a, const Float4& b)
+{
+#if DSP_SIMD_SSE
+    return { _mm_max_ps(a.v, b.v) };
+#elif DSP_SIMD_NEON
+    return { vmaxq_f32(a.v, b.v) };
+#else
+    return { { max(a.v[0], b.v[0]), max(a.v[1], b.v[1]), max(a.v[2], b.v[2]), max(a.v[3], b.v[3]) } };
+#endif
+}
+
+// Element-wise x == y ? a : b
+inline float selectEqual(float x, float y, float a, float b) { return x == y ? a : b; }
+
+inline Float4 selectEqual(const Float4& x, const Float4& y, const Float4& a, const Float4& b)
+{
+#if DSP_SIMD_SSE
+    const __m128 mask { _mm_cmpeq_ps(x.v, y.v) };
+    return { _mm_or_ps(_mm_and_ps(mask, a.v), _mm_andnot_ps(mask, b.v)) };
+#elif DSP_SIMD_NEON
+    return { vbslq_f32(vceqq_f32(x.v, y.v), a.v, b.v) };
+#else
+    return { { selectEqual(x.v[0], y.v[0], a.v[0], b.v[0]), selectEqual(x.v[1], y.v[1], a.v[1], b.v[1]),
+               selectEqual(x.v[2], y.v[2], a.v[2], b.v[2]), selectEqual(x.v[3], y.v[3], a.v[3], b.v[3]) } };
+#endif
+}
+
+// Round to the nearest integer, ties to even, |x| must be below 2^31
+inline float roundToInt(float x)
+{
+#if DSP_SIMD_SSE
+    // Same conversion as the vector flavour, nearbyint is a library call without SSE4.1
+    return static_cast<float>(_mm_cvtss_si32(_mm_set_ss(x)));
+#else
+    return std::nearbyint(x);
+#endif
+}
+
+inline Float4 roundToInt(const Float4& x)
+{
+#if DSP_SIMD_SSE
+    return { _mm_cvtepi32_ps(_mm_cvtps_epi32(x.v)) };
+#elif DSP_SIMD_NEON
+    return { vcvtq_f32_s32(vcvtnq_s32_f32(x.v)) };
+#else
+    return { { roundToInt(x.v[0]), roundToInt(x.v[1]), roundToInt(x.v[2]), roundToInt(x.v[3]) } };
+#endif
+}
+
+// 2^k for integer valued k in [-126, 127], built from the exponent bits
+inline float powerOfTwo(float k)
+{
+    const std::uint32_t bits { static_cast<std::uint32_t>(static_cast<std::int32_t>(k) + 127) << 23 };
+    float x;
+    std::memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+inline Float4 powerOfTwo(const Float4& k)
+{
+#if DSP_SIMD_SSE
+    return { _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(k.v), _mm_set1_epi32(127)), 23)) };
+#elif DSP_SIMD_NEON
+    return { vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vcvtnq_s32_f32(k.v), vdupq_n_s32(127)), 23)) };
+#else
+    return { { powerOfTwo(k.v[0]), powerOfTwo(k.v[1]), powerOfTwo(k.v[2]), powerOfTwo(k.v[3]) } };
+#endif
+}
+
+// Transpose 4 registers as the rows of a 4x4 matrix, e.g. to turn 4 loads of
+// consecutive samples into one register per offset
+inline void transpose(Float4& a, Float4& b, Float4& c, Float4& d)
+{
+#if DSP_SIMD_SSE
+    _MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v);
+#elif DSP_SIMD_NEON
+    const float32x4x2_t ab { vtrnq_f32(a.v, b.v) };
+    const float32x4x2_t cd { vtrnq_f32(c.v, d.v) };
+    a.v = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+    b.v = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+    c.v = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+    d.v = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+#else
+    const Float4 rows[Lanes] { a, b, c, d };
+    Float4* columns[Lanes] { &a, &b, &c, &d };
+    for (unsigned int i = 0; i < Lanes; ++i)
+        for (unsigned int j = 0; j < Lanes; ++j)
+            columns[i]->v[j] = rows[j].v[i];
+#endif
+}
+
+}
+
+}
@@ -1,4 +1,5 @@
 #include "StateVariableFilter.h"
+#include "FastMath.h"
 
 #include <cmath>
 #include <algorithm>
@@ -30,7 +31,8 @@ void StateVariableFilter::process(float* lpfOut, float* bpfOut, float* hpfOut, c
         float twoR = 1.f / std::clamp(resoIn[n], 0.1f, 10.f);
 
         // g = tan(pi * Fc / Fs)
-        float g = std::tan(static_cast<float>(M_PI / sampleRate) * std::clamp(freqIn[n], 20.f, 20000.f));
+        float wc = static_cast<float>(M_PI / sampleRate) * std::clamp(freqIn[n], 20.f, 20000.f);
+        float g = fastMath ? FastMath::tan(wc) : std::tan(wc);
 
         // g0 = 2R + g
         float g0 = twoR + g;
@@ -66,4 +68,9 @@ void StateVariableFilter::process(float* lpfOut, float* bpfOut, float* hpfOut, c
     }
 }
 
+void StateVariableFilter::setFastMath(bool useFastMath)
+{
+    fastMath = useFastMath;
+}
+
 }
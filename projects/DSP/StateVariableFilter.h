@@ -20,11 +20,16 @@ public:
                  const float* audioIn, const float* freqIn, const float* resoIn,
                  unsigned int numSamples);
 
+    // Warp the cutoff with the FastMath approximation of tan instead of the standard library
+    void setFastMath(bool useFastMath);
+
 private:
     double sampleRate { 48000.0 };
 
     float state0 { 0.f };
     float state1 { 0.f };
+
+    bool fastMath { false };
 };
 
 }
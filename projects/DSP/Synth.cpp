@@ -10,9 +10,9 @@ float convertMidiNoteToFreq(int MidiNote)
 
 SynthVoice::SynthVoice()
 {
-    sawOsc.setType(Oscillator::SawAA);
-    triOsc.setType(Oscillator::TriAA);
-    sinOsc.setType(Oscillator::Sin);
+    sawOsc.setWaveform(Wavetable::Saw);
+    triOsc.setWaveform(Wavetable::Tri);
+    sinOsc.setWaveform(Wavetable::Sin);
 
     vcaEnvGen.setAnalogStyle(false);
     vcfEnvGen.setAnalogStyle(false);
@@ -24,22 +24,22 @@ SynthVoice::~SynthVoice()
 
 void SynthVoice::setOscSawVol(float dB, bool skipRamp)
 {
-    sawOscVolRamp.setTarget(std::pow(10.f, 0.05f * dB), skipRamp);
+    ramps.setTarget(SawOscVol, std::pow(10.f, 0.05f * dB), skipRamp);
 }
 
 void SynthVoice::setOscTriVol(float dB, bool skipRamp)
 {
-    triOscVolRamp.setTarget(std::pow(10.f, 0.05f * dB), skipRamp);
+    ramps.setTarget(TriOscVol, std::pow(10.f, 0.05f * dB), skipRamp);
 }
 
 void SynthVoice::setOscSinVol(float dB, bool skipRamp)
 {
-    sinOscVolRamp.setTarget(std::pow(10.f, 0.05f * dB), skipRamp);
+    ramps.setTarget(SinOscVol, std::pow(10.f, 0.05f * dB), skipRamp);
 }
 
 void SynthVoice::setOscVol(float dB, bool skipRamp)
 {
-    oscVolRamp.setTarget(std::pow(10.f, 0.05f * dB), skipRamp);
+    ramps.setTarget(OscVol, std::pow(10.f, 0.05f * dB), skipRamp);
 }
 
 void SynthVoice::setAttTimeVCA(float ms)
@@ -85,44 +85,45 @@ void SynthVoice::setRelTimeVCF(float ms)
 void SynthVoice::setLFOFreqVCF(float Hz)
 {
     lfoFreq = std::fmax(Hz, 0.f);
-    lfoPhaseInc = static_cast<float>(2.0 * M_PI / sampleRate) * lfoFreq;
+    lfo.setFrequency(lfoFreq);
 }
 
 void SynthVoice::setLFOTypeVCF(LFOType type)
 {
     lfoType = type;
+    lfo.setWaveform(lfoType == TRI ? Lfo::Tri : Lfo::Sin);
 }
 
 void SynthVoice::setEnvAmountVCF(float bipolar, bool skipRamp)
 {
-    vcfEnvAmountRamp.setTarget(std::clamp(bipolar, -1.f, 1.f), skipRamp);
+    ramps.setTarget(VcfEnvAmount, std::clamp(bipolar, -1.f, 1.f), skipRamp);
 }
 
 void SynthVoice::setLFOAmountVCF(float bipolar, bool skipRamp)
 {
-    vcfLFOAmountRamp.setTarget(std::clamp(bipolar, -1.f, 1.f), skipRamp);
+    ramps.setTarget(VcfLFOAmount, std::clamp(bipolar, -1.f, 1.f), skipRamp);
 }
 
 void SynthVoice::setFilterCutoff(float Hz, bool skipRamp)
 {
-    vcfFreqRamp.setTarget(std::clamp(Hz, MinFreqHz, MaxFreqHz), skipRamp);
+    ramps.setTarget(VcfFreq, std::clamp(Hz, MinFreqHz, MaxFreqHz), skipRamp);
 }
 
 void SynthVoice::setFilterReso(float Q, bool skipRamp)
 {
-    vcfResoRamp.setTarget(std::clamp(Q, MinReso, MaxReso), skipRamp);
+    ramps.setTarget(VcfReso, std::clamp(Q, MinReso, MaxReso), skipRamp);
 }
 
 void SynthVoice::setFilterType(FilterType type, bool skipRamp)
 {
-    vcfLPFRamp.setTarget(type == LPF ? 1.f : 0.f, skipRamp);
-    vcfBPFRamp.setTarget(type == BPF ? 1.f : 0.f, skipRamp);
-    vcfHPFRamp.setTarget(type == HPF ? 1.f : 0.f, skipRamp);
+    ramps.setTarget(VcfLPF, type == LPF ? 1.f : 0.f, skipRamp);
+    ramps.setTarget(VcfBPF, type == BPF ? 1.f : 0.f, skipRamp);
+    ramps.setTarget(VcfHPF, type == HPF ? 1.f : 0.f, skipRamp);
 }
 
 void SynthVoice::setOutputVol(float dB, bool skipRamp)
 {
-    outputVolRamp.setTarget(std::pow(10.f, 0.05f * dB), skipRamp);
+    ramps.setTarget(OutputVol, std::pow(10.f, 0.05f * dB), skipRamp);
 }
 
 
@@ -173,83 +174,83 @@ void SynthVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int sta
         vcaEnvGen.prepare(sampleRate);
         vcfEnvGen.prepare(sampleRate);
         filter.prepare(sampleRate);
-        sinOscVolRamp.prepare(sampleRate);
-        triOscVolRamp.prepare(sampleRate);
-        sawOscVolRamp.prepare(sampleRate);
-        oscVolRamp.prepare(sampleRate);
-        outputVolRamp.prepare(sampleRate);
-        vcfEnvAmountRamp.prepare(sampleRate);
-        vcfLFOAmountRamp.prepare(sampleRate);
-        vcfFreqRamp.prepare(sampleRate);
-        vcfResoRamp.prepare(sampleRate);
-        vcfLPFRamp.prepare(sampleRate);
-        vcfBPFRamp.prepare(sampleRate);
-        vcfHPFRamp.prepare(sampleRate);
-
-        lfoPhaseInc = static_cast<float>(2.0 * M_PI / sampleRate) * std::fmax(lfoFreq, 0.f);
+        ramps.prepare(sampleRate);
+
+        lfo.prepare(sampleRate);
     }
 
-    for (int i = 0; i < numSamples; ++i)
+    // Parameters and LFO are rendered per chunk, the ramp rows hold MaxBlockSize samples
+    constexpr int ChunkSize { static_cast<int>(RampBank<NumRamps>::MaxBlockSize) };
+    for (int i0 = 0; i0 < numSamples; i0 += ChunkSize)
     {
-        const auto sin { sinOsc.process() };
-        const auto tri { triOsc.process() };
-        const auto saw { sawOsc.process() };
-
-        float vcaEnv { 0.f };
-        vcaEnvGen.process(&vcaEnv, 1);
+        const int chunkSamples { std::min(numSamples - i0, ChunkSize) };
 
-        float vcfEnv { 0.f };
-        vcfEnvGen.process(&vcfEnv, 1);
+        ramps.process(static_cast<unsigned int>(chunkSamples));
 
-        const auto sinVol { sinOscVolRamp.getNext() };
-        const auto triVol { triOscVolRamp.getNext() };
-        const auto sawVol { sawOscVolRamp.getNext() };
-        const auto oscVol { oscVolRamp.getNext() };
+        const float* sinVol { ramps.getRow(SinOscVol) };
+        const float* triVol { ramps.getRow(TriOscVol) };
+        const float* sawVol { ramps.getRow(SawOscVol) };
+        const float* oscVol { ramps.getRow(OscVol) };
 
-        const auto vcfEnvAmout { vcfEnvAmountRamp.getNext() };
-        const auto vcfLFOAmount { vcfLFOAmountRamp.getNext() };
+        const float* vcfEnvAmout { ramps.getRow(VcfEnvAmount) };
+        const float* vcfLFOAmount { ramps.getRow(VcfLFOAmount) };
 
-        const auto vcfFreq { vcfFreqRamp.getNext() };
-        const auto vcfReso { vcfResoRamp.getNext() };
-        const auto vcfLPF { vcfLPFRamp.getNext() };
-        const auto vcfBPF { vcfBPFRamp.getNext() };
-        const auto vcfHPF { vcfHPFRamp.getNext() };
+        const float* vcfFreq { ramps.getRow(VcfFreq) };
+        const float* vcfReso { ramps.getRow(VcfReso) };
+        const float* vcfLPF { ramps.getRow(VcfLPF) };
+        const float* vcfBPF { ramps.getRow(VcfBPF) };
+        const float* vcfHPF { ramps.getRow(VcfHPF) };
 
-        const auto outputVol { outputVolRamp.getNext() };
+        const float* outputVol { ramps.getRow(OutputVol) };
 
         // Process LFO acording to mod type
-        float lfo { 0.f };
-        switch (lfoType)
-        {
-        case TRI:
-            lfo = std::fabs((lfoPhaseState - static_cast<float>(M_PI)) / static_cast<float>(M_PI));
-            break;
-
-        case SIN:
-            lfo = 0.5f + 0.5f * std::sin(lfoPhaseState);
-            break;
-        }
-        lfoPhaseState = std::fmod(lfoPhaseState + lfoPhaseInc, static_cast<float>(2 * M_PI));
-
-        const auto oscOut { (sin * sinVol + tri * triVol + saw * sawVol) * oscVol * vcaEnv * velocity };
-        const auto freqMod { std::clamp(vcfEnv * vcfEnvAmout + vcfLFOAmount * lfo, -1.f, 1.f) };
-        const auto freq { std::clamp(FreqModRange * (std::pow(2.f, freqMod) - 1.f) + vcfFreq, MinFreqHz, MaxFreqHz) };
-
-        float lpfOut { 0.f };
-        float bpfOut { 0.f };
-        float hpfOut { 0.f };
-        filter.process(&lpfOut, &bpfOut, &hpfOut, &oscOut, &freq, &vcfReso, 1);
-
-        const auto out { (vcfLPF * lpfOut + vcfBPF * bpfOut + vcfHPF * hpfOut) * outputVol };
-        for (int ch = 0; ch < outputBuffer.getNumChannels(); ++ch)
-        {
-            outputBuffer.addSample(ch, startSample + i, out);
-        }
-
-        if (voiceStarted && vcaEnvGen.isOff() && vcfEnvGen.isOff())
+        float lfoChunk[ChunkSize];
+        float* lfoOut { lfoChunk };
+        lfo.process(&lfoOut, 1, static_cast<unsigned int>(chunkSamples));
+
+        // Oscillators run their block kernels over the chunk
+        float sinChunk[ChunkSize];
+        float triChunk[ChunkSize];
+        float sawChunk[ChunkSize];
+        sinOsc.process(sinChunk, static_cast<unsigned int>(chunkSamples));
+        triOsc.process(triChunk, static_cast<unsigned int>(chunkSamples));
+        sawOsc.process(sawChunk, static_cast<unsigned int>(chunkSamples));
+
+        for (int k = 0; k < chunkSamples; ++k)
         {
-            voiceStarted = false;
-            clearCurrentNote();
+            const auto sin { sinChunk[k] };
+            const auto tri { triChunk[k] };
+            const auto saw { sawChunk[k] };
+
+            float vcaEnv { 0.f };
+            vcaEnvGen.process(&vcaEnv, 1);
+
+            float vcfEnv { 0.f };
+            vcfEnvGen.process(&vcfEnv, 1);
+
+            // From bipolar to unipolar
+            const auto lfoValue { 0.5f + 0.5f * lfoChunk[k] };
+
+            const auto oscOut { (sin * sinVol[k] + tri * triVol[k] + saw * sawVol[k]) * oscVol[k] * vcaEnv * velocity };
+            const auto freqMod { std::clamp(vcfEnv * vcfEnvAmout[k] + vcfLFOAmount[k] * lfoValue, -1.f, 1.f) };
+            const auto freq { std::clamp(FreqModRange * (std::pow(2.f, freqMod) - 1.f) + vcfFreq[k], MinFreqHz, MaxFreqHz) };
+
+            float lpfOut { 0.f };
+            float bpfOut { 0.f };
+            float hpfOut { 0.f };
+            filter.process(&lpfOut, &bpfOut, &hpfOut, &oscOut, &freq, vcfReso + k, 1);
+
+            const auto out { (vcfLPF[k] * lpfOut + vcfBPF[k] * bpfOut + vcfHPF[k] * hpfOut) * outputVol[k] };
+            for (int ch = 0; ch < outputBuffer.getNumChannels(); ++ch)
+            {
+                outputBuffer.addSample(ch, startSample + i0 + k, out);
+            }
+
+            if (voiceStarted && vcaEnvGen.isOff() && vcfEnvGen.isOff())
+            {
+                voiceStarted = false;
+                clearCurrentNote();
+            }
         }
     }
 }
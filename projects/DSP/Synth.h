@@ -2,10 +2,11 @@
 
 #include <JuceHeader.h>
 
-#include "Oscillator.h"
+#include "WavetableOscillator.h"
 #include "EnvelopeGenerator.h"
+#include "Lfo.h"
 #include "StateVariableFilter.h"
-#include "Ramp.h"
+#include "RampBank.h"
 
 namespace DSP
 {
@@ -93,9 +94,9 @@ private:
     float lfoFreq { 1.f };
     float velocity { 1.f };
 
-    Oscillator sinOsc;
-    Oscillator triOsc;
-    Oscillator sawOsc;
+    WavetableOscillator sinOsc;
+    WavetableOscillator triOsc;
+    WavetableOscillator sawOsc;
 
     EnvelopeGenerator vcaEnvGen;
     EnvelopeGenerator vcfEnvGen;
@@ -103,23 +104,27 @@ private:
     StateVariableFilter filter;
 
     LFOType lfoType;
-    float lfoPhaseState { 0.f };
-    float lfoPhaseInc { 0.f };
-
-    Ramp<float> sinOscVolRamp;
-    Ramp<float> triOscVolRamp;
-    Ramp<float> sawOscVolRamp;
-    Ramp<float> oscVolRamp;
-    Ramp<float> outputVolRamp;
-
-    Ramp<float> vcfEnvAmountRamp;
-    Ramp<float> vcfLFOAmountRamp;
-
-    Ramp<float> vcfFreqRamp;
-    Ramp<float> vcfResoRamp;
-    Ramp<float> vcfLPFRamp;
-    Ramp<float> vcfBPFRamp;
-    Ramp<float> vcfHPFRamp;
+    Lfo lfo { 1 };
+
+    // Smoothed parameters, rows of the ramp bank
+    enum RampIndex : unsigned int
+    {
+        SinOscVol = 0,
+        TriOscVol,
+        SawOscVol,
+        OscVol,
+        OutputVol,
+        VcfEnvAmount,
+        VcfLFOAmount,
+        VcfFreq,
+        VcfReso,
+        VcfLPF,
+        VcfBPF,
+        VcfHPF,
+        NumRamps
+    };
+
+    RampBank<NumRamps> ramps;
 
     bool voiceStarted { false };
 };
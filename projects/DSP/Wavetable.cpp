@@ -0,0 +1,171 @@
+#include "Wavetable.h"
+#include "Fft.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <memory>
+
+namespace DSP
+{
+
+namespace
+{
+    // Built-in tables of the process, generated by a background thread started on first use
+    // and published one by one as they are ready
+    class SharedTables
+    {
+    public:
+        static SharedTables& get()
+        {
+            static SharedTables instance;
+            return instance;
+        }
+
+        const Wavetable* getTable(Wavetable::Waveform waveform) const
+        {
+            return published[waveform].load(std::memory_order_acquire);
+        }
+
+        void wait() const
+        {
+            generated.wait();
+        }
+
+    private:
+        SharedTables() :
+            generated { std::async(std::launch::async, [this] { generate(); }).share() }
+        { }
+
+        std::array<std::unique_ptr<Wavetable>, Wavetable::NumWaveforms> tables;
+        std::array<std::atomic<const Wavetable*>, Wavetable::NumWaveforms> published {};
+
+        // Declared last, so the thread starts after the tables are constructed
+        // and is joined before they are destroyed
+        std::shared_future<void> generated;
+
+        void generate()
+        {
+            const double pi { M_PI };
+            std::array<float, Wavetable::MaxHarmonics + 1> sinAmplitudes;
+            std::array<float, Wavetable::MaxHarmonics + 1> cosAmplitudes;
+
+            for (unsigned int w = 0; w < Wavetable::NumWaveforms; ++w)
+            {
+                sinAmplitudes.fill(0.f);
+                cosAmplitudes.fill(0.f);
+
+                for (unsigned int k = 1; k <= Wavetable::MaxHarmonics; ++k)
+                {
+                    const bool odd { (k & 1u) != 0 };
+                    switch (w)
+                    {
+                    case Wavetable::Sin:
+                        sinAmplitudes[k] = k == 1 ? 1.f : 0.f;
+                        break;
+
+                    case Wavetable::Tri:
+                        cosAmplitudes[k] = odd ? static_cast<float>(8.0 / (pi * pi * k * k)) : 0.f;
+                        break;
+
+                    case Wavetable::Saw:
+                        sinAmplitudes[k] = static_cast<float>(-2.0 / (pi * k));
+                        break;
+
+                    case Wavetable::Sqr:
+                        sinAmplitudes[k] = odd ? static_cast<float>(-4.0 / (pi * k)) : 0.f;
+                        break;
+                    }
+                }
+
+                tables[w] = std::make_unique<Wavetable>(sinAmplitudes.data() + 1, cosAmplitudes.data() + 1, Wavetable::MaxHarmonics);
+                published[w].store(tables[w].get(), std::memory_order_release);
+            }
+        }
+    };
+}
+
+Wavetable::Wavetable(const float* sinAmplitudes, const float* cosAmplitudes, unsigned int numHarmonics)
+{
+    numHarmonics = std::min(numHarmonics, MaxHarmonics);
+
+    std::vector<float> real(MaxHarmonics + 1, 0.f);
+    std::vector<float> imag(MaxHarmonics + 1, 0.f);
+    for (unsigned int k = 1; k <= numHarmonics; ++k)
+    {
+        real[k] = cosAmplitudes[k - 1];
+        imag[k] = -sinAmplitudes[k - 1];
+    }
+
+    build(real.data(), imag.data(), numHarmonics);
+}
+
+Wavetable::Wavetable(const float* cycle, unsigned int cycleLength)
+{
+    Fft fft(cycleLength);
+    std::vector<float> real(fft.getNumBins(), 0.f);
+    std::vector<float> imag(fft.getNumBins(), 0.f);
+    fft.forward(cycle, real.data(), imag.data());
+
+    // A harmonic of amplitude a shows up as a * cycleLength / 2, except at Nyquist
+    const unsigned int numHarmonics { std::min(cycleLength / 2, MaxHarmonics) };
+    for (unsigned int k = 1; k <= numHarmonics; ++k)
+    {
+        const float scale { (k == cycleLength / 2 ? 1.f : 2.f) / static_cast<float>(cycleLength) };
+        real[k] *= scale;
+        imag[k] *= scale;
+    }
+
+    build(real.data(), imag.data(), numHarmonics);
+}
+
+Wavetable::~Wavetable()
+{
+}
+
+const Wavetable* Wavetable::getShared(Waveform waveform)
+{
+    return waveform < NumWaveforms ? SharedTables::get().getTable(waveform) : nullptr;
+}
+
+void Wavetable::waitForShared()
+{
+    SharedTables::get().wait();
+}
+
+void Wavetable::build(const float* real, const float* imag, unsigned int numHarmonics)
+{
+    levels.assign(NumLevels * RowSize, 0.f);
+
+    Fft fft(TableSize);
+    std::vector<float> levelReal(fft.getNumBins(), 0.f);
+    std::vector<float> levelImag(fft.getNumBins(), 0.f);
+
+    // Levels drop harmonics from the top, so every bin above the level is already zero
+    const float scale { static_cast<float>(TableSize / 2) };
+    for (unsigned int k = 1; k <= numHarmonics; ++k)
+    {
+        levelReal[k] = real[k] * scale;
+        levelImag[k] = imag[k] * scale;
+    }
+
+    for (unsigned int level = 0; level < NumLevels; ++level)
+    {
+        for (unsigned int k = getLevelHarmonics(level) + 1; k <= numHarmonics; ++k)
+            levelReal[k] = levelImag[k] = 0.f;
+
+        float* row { levels.data() + level * RowSize };
+        fft.inverse(levelReal.data(), levelImag.data(), row + GuardBefore);
+
+        // Wrap the cycle around into the guards
+        for (unsigned int n = 0; n < GuardBefore; ++n)
+            row[n] = row[TableSize + n];
+
+        for (unsigned int n = 0; n < GuardAfter; ++n)
+            row[GuardBefore + TableSize + n] = row[GuardBefore + n];
+    }
+}
+
+}
\ No newline at end of file
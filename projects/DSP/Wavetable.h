@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+
+namespace DSP
+{
+
+// Single cycle waveform stored as band-limited mipmap levels, one per octave
+// Level L holds the harmonics up to MaxHarmonics >> L, so an oscillator picks the level
+// whose highest harmonic stays below Nyquist and never aliases
+// Tables are read-only once built, so any number of oscillators on any thread can share one
+// The built-in waveforms are generated once per process on a background thread, started by
+// the first getShared call, and shared by every plugin instance and voice
+class Wavetable
+{
+public:
+    // Built-in waveforms, all bipolar and following the Oscillator phase
+    //  - Sin: starts at 0 rising
+    //  - Tri: starts at 1 and reaches -1 at half the cycle
+    //  - Saw: rises from -1 to 1
+    //  - Sqr: -1 for the first half of the cycle and 1 for the second
+    enum Waveform : unsigned int
+    {
+        Sin = 0,
+        Tri,
+        Saw,
+        Sqr,
+        NumWaveforms
+    };
+
+    // Samples per cycle of every level
+    static constexpr unsigned int TableSize { 4096 };
+
+    // Harmonics of the first level, the first level covers fundamentals up to Nyquist / MaxHarmonics
+    static constexpr unsigned int MaxHarmonics { 1024 };
+
+    // One level per octave down to a single harmonic
+    static constexpr unsigned int NumLevels { 11 };
+
+    // Samples before and after the cycle, wrapped around for the cubic interpolation
+    static constexpr unsigned int GuardBefore { 1 };
+    static constexpr unsigned int GuardAfter { 2 };
+    static constexpr unsigned int RowSize { GuardBefore + TableSize + GuardAfter };
+
+    // Main ctor
+    // Requires the sine and cosine amplitudes of harmonics 1 to numHarmonics,
+    // harmonics above MaxHarmonics are dropped
+    Wavetable(const float* sinAmplitudes, const float* cosAmplitudes, unsigned int numHarmonics);
+
+    // Single cycle ctor
+    // cycleLength must be a power of two, 4 or above, the DC offset of the cycle is removed
+    Wavetable(const float* cycle, unsigned int cycleLength);
+
+    // Dtor
+    ~Wavetable();
+
+    // No default ctor
+    Wavetable() = delete;
+
+    // No copy semantics
+    Wavetable(const Wavetable&) = delete;
+    const Wavetable& operator=(const Wavetable&) = delete;
+
+    // No move semantics
+    Wavetable(Wavetable&&) = delete;
+    const Wavetable& operator=(Wavetable&&) = delete;
+
+    // return the first sample of a level, GuardBefore samples are readable before it
+    // and GuardAfter samples after the end of the cycle
+    const float* getLevel(unsigned int level) const noexcept { return levels.data() + level * RowSize + GuardBefore; }
+
+    // return the highest harmonic of a level
+    static constexpr unsigned int getLevelHarmonics(unsigned int level) { return MaxHarmonics >> level; }
+
+    // return a built-in table shared by the whole process, or nullptr while it is being generated
+    // The first call starts generating all built-in tables on a background thread, it allocates
+    // so it belongs in a ctor or prepare, later calls are a lock-free load
+    static const Wavetable* getShared(Waveform waveform);
+
+    // Block until the built-in tables are generated, e.g. before rendering offline
+    static void waitForShared();
+
+private:
+    // Levels of RowSize samples, the cycle in the middle of the guards
+    std::vector<float> levels;
+
+    // Build every level from harmonics 1 to numHarmonics of a spectrum
+    // split in cosine (real) and negated sine (imaginary) amplitudes of TableSize / 2 each
+    void build(const float* real, const float* imag, unsigned int numHarmonics);
+};
+
+}
\ No newline at end of file
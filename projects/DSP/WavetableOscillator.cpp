@@ -0,0 +1,136 @@
+#include "WavetableOscillator.h"
+#include "Phase.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DSP
+{
+
+WavetableOscillator::WavetableOscillator()
+{
+    table = Wavetable::getShared(waveform);
+    updateIncrement();
+}
+
+WavetableOscillator::~WavetableOscillator()
+{
+}
+
+void WavetableOscillator::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    updateIncrement();
+    reset();
+}
+
+void WavetableOscillator::reset()
+{
+    phase = 0;
+}
+
+void WavetableOscillator::process(float* output, unsigned int numSamples)
+{
+    // A shared table is picked up as soon as it is published
+    if (table == nullptr)
+        table = Wavetable::getShared(waveform);
+
+    if (table == nullptr)
+    {
+        std::fill(output, output + numSamples, 0.f);
+        phase += phaseInc * numSamples;
+        return;
+    }
+
+    const float* row { table->getLevel(level) };
+    for (unsigned int n = 0; n < numSamples; n += ChunkSize)
+        processChunk(row, output + n, std::min(numSamples - n, ChunkSize));
+}
+
+float WavetableOscillator::process()
+{
+    float osc { 0.f };
+    process(&osc, 1);
+
+    return osc;
+}
+
+void WavetableOscillator::setFrequency(float freqHz)
+{
+    frequency = std::clamp(freqHz, 0.1f, 20000.f);
+    updateIncrement();
+}
+
+void WavetableOscillator::setWaveform(Wavetable::Waveform newWaveform)
+{
+    waveform = newWaveform < Wavetable::NumWaveforms ? newWaveform : Wavetable::Sin;
+    if (customTable == nullptr)
+        table = Wavetable::getShared(waveform);
+}
+
+void WavetableOscillator::setWavetable(const Wavetable* newTable)
+{
+    customTable = newTable;
+    table = customTable != nullptr ? customTable : Wavetable::getShared(waveform);
+}
+
+void WavetableOscillator::updateIncrement()
+{
+    phaseInc = Phase::increment(frequency, sampleRate);
+
+    // First level whose highest harmonic stays at or below Nyquist, half a cycle per sample
+    level = 0;
+    while (level + 1 < Wavetable::NumLevels
+           && static_cast<std::uint64_t>(Wavetable::getLevelHarmonics(level)) * phaseInc > 0x80000000u)
+        ++level;
+}
+
+void WavetableOscillator::processChunk(const float* row, float* output, unsigned int numSamples)
+{
+    using Simd::Float4;
+
+    // Whole registers, the extra samples read valid table entries and are dropped
+    const unsigned int vectorSamples { (numSamples + Simd::Lanes - 1) / Simd::Lanes * Simd::Lanes };
+
+    constexpr std::uint32_t FractionMask { (1u << FractionBits) - 1u };
+    const Float4 fractionScale { Float4::broadcast(1.f / static_cast<float>(1u << FractionBits)) };
+
+    const Float4 half { Float4::broadcast(0.5f) };
+    const Float4 oneAndHalf { Float4::broadcast(1.5f) };
+    const Float4 two { Float4::broadcast(2.f) };
+    const Float4 twoAndHalf { Float4::broadcast(2.5f) };
+
+    alignas(16) float y[ChunkSize];
+    std::uint32_t p0 { phase };
+    for (unsigned int n = 0; n < vectorSamples; n += Simd::Lanes)
+    {
+        const std::uint32_t p1 { p0 + phaseInc };
+        const std::uint32_t p2 { p1 + phaseInc };
+        const std::uint32_t p3 { p2 + phaseInc };
+
+        // The four taps around every sample, transposed into one register per tap
+        Float4 a { Float4::load(row + (p0 >> FractionBits) - 1) };
+        Float4 b { Float4::load(row + (p1 >> FractionBits) - 1) };
+        Float4 c { Float4::load(row + (p2 >> FractionBits) - 1) };
+        Float4 d { Float4::load(row + (p3 >> FractionBits) - 1) };
+        Simd::transpose(a, b, c, d);
+
+        const Float4 t { Float4::set(static_cast<float>(p0 & FractionMask), static_cast<float>(p1 & FractionMask),
+                                     static_cast<float>(p2 & FractionMask), static_cast<float>(p3 & FractionMask)) * fractionScale };
+        p0 = p3 + phaseInc;
+
+        // Catmull-Rom cubic through the taps
+        const Float4 c1 { half * (c - a) };
+        const Float4 c2 { a - twoAndHalf * b + two * c - half * d };
+        const Float4 c3 { half * (d - a) + oneAndHalf * (b - c) };
+
+        (((c3 * t + c2) * t + c1) * t + b).store(y + n);
+    }
+
+    phase += phaseInc * numSamples;
+
+    std::copy(y, y + numSamples, output);
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Wavetable.h"
+
+#include <cstdint>
+
+namespace DSP
+{
+
+// Audio rate oscillator reading a band-limited Wavetable
+// The phase is a 32 bit integer accumulator, its top bits index the table and the rest
+// is the fraction of a cubic interpolation calculated Simd::Lanes samples at a time
+// The level is picked from the frequency so no harmonic goes above Nyquist, which makes
+// any waveform alias free without transcendentals or differentiators per sample
+// Until the shared table is generated the oscillator outputs silence, keeping its phase
+class WavetableOscillator
+{
+public:
+    // Main ctor, starts generating the shared tables if they are not already
+    WavetableOscillator();
+
+    // Dtor
+    ~WavetableOscillator();
+
+    // No copy semantics
+    WavetableOscillator(const WavetableOscillator&) = delete;
+    const WavetableOscillator& operator=(const WavetableOscillator&) = delete;
+
+    // No move semantics
+    WavetableOscillator(WavetableOscillator&&) = delete;
+    const WavetableOscillator& operator=(WavetableOscillator&&) = delete;
+
+    // Update sample rate and restart the cycle
+    void prepare(double sampleRate);
+
+    // Restart the cycle
+    void reset();
+
+    // Process oscillator output for a buffer
+    void process(float* output, unsigned int numSamples);
+
+    // Process a single sample of the oscillator
+    float process();
+
+    // Set a new frequency for the oscillator in Hz
+    void setFrequency(float freqHz);
+
+    // Select one of the shared built-in waveforms
+    void setWaveform(Wavetable::Waveform newWaveform);
+
+    // Select a custom table, which has to outlive its use by the oscillator
+    // nullptr goes back to the shared built-in waveform
+    void setWavetable(const Wavetable* newTable);
+
+    // return the frequency in Hz
+    float getFrequency() const noexcept { return frequency; }
+
+    // return the built-in waveform
+    Wavetable::Waveform getWaveform() const noexcept { return waveform; }
+
+private:
+    static constexpr unsigned int ChunkSize { 64 };
+
+    // Bits of the phase below the table index, used as the interpolation fraction
+    static constexpr unsigned int FractionBits { 20 };
+    static_assert((1u << (32 - FractionBits)) == Wavetable::TableSize, "The table index is the top bits of the phase");
+
+    double sampleRate { 48000.0 };
+    float frequency { 440.f };
+    Wavetable::Waveform waveform { Wavetable::Sin };
+
+    // Table in use, either custom or shared, and its level for the frequency
+    const Wavetable* customTable { nullptr };
+    const Wavetable* table { nullptr };
+    unsigned int level { 0 };
+
+    // Phase and its increment per sample, a full cycle is 2^32
+    std::uint32_t phase { 0 };
+    std::uint32_t phaseInc { 0 };
+
+    // Recalculate the phase increment and the level for the frequency and sample rate
+    void updateIncrement();
+
+    // Process up to ChunkSize samples from a level
+    void processChunk(const float* row, float* output, unsigned int numSamples);
+};
+
+}
\ No newline at end of file
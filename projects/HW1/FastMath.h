@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Simd.h"
+
+namespace DSP
+{
+
+// Polynomial and rational approximations of transcendental functions
+// Every function is a template over float and Simd::Float4, so the same
+// code runs one value or Simd::Lanes values at once
+// Polynomials are evaluated with Estrin's scheme, a shorter dependency chain than Horner's
+// Error bounds are the largest error measured against double precision over the valid range,
+// see snipets/fastmath_vs_libm.cpp
+namespace FastMath
+{
+
+// tan(x) for |x| < pi / 2
+// x P(x^2) / (pi^2 / 4 - x^2) with P fitted on Chebyshev nodes, the pole is kept exact
+// Max relative error 3.5e-7 in float
+template<typename T>
+T tan(T x)
+{
+    constexpr float PiOver2Hi { 1.57079625f };
+    constexpr float PiOver2Lo { 7.54978942e-8f };
+
+    const T x2 { x * x };
+    const T x4 { x2 * x2 };
+    const T p01 { Simd::broadcast<T>(2.467401021f) + Simd::broadcast<T>(-1.775313685e-1f) * x2 };
+    const T p23 { Simd::broadcast<T>(-4.351641069e-3f) + Simd::broadcast<T>(-1.663411012e-4f) * x2 };
+    const T p { p01 + (p23 + Simd::broadcast<T>(-9.929255030e-6f) * x4) * x4 };
+
+    const T distanceToPole { (Simd::broadcast<T>(PiOver2Hi) - x) + Simd::broadcast<T>(PiOver2Lo) };
+    const T distanceToNegativePole { (Simd::broadcast<T>(PiOver2Hi) + x) + Simd::broadcast<T>(PiOver2Lo) };
+    return x * p / (distanceToPole * distanceToNegativePole);
+}
+
+// 2^f for |f| <= 0.5, the building block of exp2 and exp
+// Degree 6 polynomial, max relative error 1.8e-7 in float
+template<typename T>
+T exp2Fraction(T f)
+{
+    const T f2 { f * f };
+    const T f4 { f2 * f2 };
+    const T p01 { Simd::broadcast<T>(1.f) + Simd::broadcast<T>(6.931472028550421e-1f) * f };
+    const T p23 { Simd::broadcast<T>(2.402264791363012e-1f) + Simd::broadcast<T>(5.550332471162809e-2f) * f };
+    const T p45 { Simd::broadcast<T>(9.618437357674640e-3f) + Simd::broadcast<T>(1.339887440266574e-3f) * f };
+    const T p6 { Simd::broadcast<T>(1.535336188319500e-4f) };
+    return (p01 + p23 * f2) + (p45 + p6 * f2) * f4;
+}
+
+// 2^x, x is clamped to [-126, 126]
+// Integer part goes to the exponent bits, fractional part in [-0.5, 0.5] to exp2Fraction
+// Max relative error 1.8e-7 in float
+template<typename T>
+T exp2(T x)
+{
+    x = Simd::min(Simd::max(x, Simd::broadcast<T>(-126.f)), Simd::broadcast<T>(126.f));
+
+    const T k { Simd::roundToInt(x) };
+    return exp2Fraction(x - k) * Simd::powerOfTwo(k);
+}
+
+// e^x, x is clamped to [-87, 87]
+// x = k ln(2) + r with ln(2) split in two so k ln(2) is exact (Cody-Waite), e^r goes to exp2Fraction
+// Max relative error 1.8e-7 in float
+template<typename T>
+T exp(T x)
+{
+    constexpr float Log2E { 1.44269504f };
+    constexpr float Ln2Hi { 0.693145752f };
+    constexpr float Ln2Lo { 1.42860677e-6f };
+
+    x = Simd::min(Simd::max(x, Simd::broadcast<T>(-87.f)), Simd::broadcast<T>(87.f));
+
+    const T k { Simd::roundToInt(x * Simd::broadcast<T>(Log2E)) };
+    const T r { (x - k * Simd::broadcast<T>(Ln2Hi)) - k * Simd::broadcast<T>(Ln2Lo) };
+    return exp2Fraction(r * Simd::broadcast<T>(Log2E)) * Simd::powerOfTwo(k);
+}
+
+// sin(x) for |x| < 8192 pi
+// x = k pi + r with pi split in three so every k pi term is exact (Cody-Waite),
+// sin(r) for |r| <= pi / 2 is r P(r^2) fitted for minimax relative error, sin(x) = (-1)^k sin(r)
+// Max absolute error 1.9e-7 in float
+template<typename T>
+T sin(T x)
+{
+    constexpr float InvPi { 0.318309886f };
+    constexpr float PiA { 3.140625f };
+    constexpr float PiB { 9.67502594e-4f };
+    constexpr float PiC { 1.50995799e-7f };
+
+    const T k { Simd::roundToInt(x * Simd::broadcast<T>(InvPi)) };
+    const T r { ((x - k * Simd::broadcast<T>(PiA)) - k * Simd::broadcast<T>(PiB)) - k * Simd::broadcast<T>(PiC) };
+
+    // Parity of k is k - 2 round(k / 2), 0 when even and +-1 when odd
+    const T one { Simd::broadcast<T>(1.f) };
+    const T two { Simd::broadcast<T>(2.f) };
+    const T parity { k - two * Simd::roundToInt(k * Simd::broadcast<T>(0.5f)) };
+    const T sign { one - two * parity * parity };
+
+    const T r2 { r * r };
+    const T r4 { r2 * r2 };
+    const T p01 { Simd::broadcast<T>(9.99999995e-1f) + Simd::broadcast<T>(-1.66666567e-1f) * r2 };
+    const T p23 { Simd::broadcast<T>(8.33302529e-3f) + Simd::broadcast<T>(-1.98074267e-4f) * r2 };
+    const T p { p01 + (p23 + Simd::broadcast<T>(2.60191703e-6f) * r4) * r4 };
+
+    return sign * r * p;
+}
+
+// tanh(x) for any x
+// x P(x^2) / Q(x^2) fitted for minimax relative error on [-9, 9], beyond it tanh rounds to +-1
+// and x is clamped
+// Max relative error 3.7e-7 in float
+template<typename T>
+T tanh(T x)
+{
+    x = Simd::min(Simd::max(x, Simd::broadcast<T>(-9.f)), Simd::broadcast<T>(9.f));
+
+    const T x2 { x * x };
+    const T x4 { x2 * x2 };
+    const T x8 { x4 * x4 };
+    const T p01 { Simd::broadcast<T>(9.99999980e-1f) + Simd::broadcast<T>(1.33809959e-1f) * x2 };
+    const T p23 { Simd::broadcast<T>(3.49555256e-3f) + Simd::broadcast<T>(2.06084961e-5f) * x2 };
+    const T q01 { Simd::broadcast<T>(1.f) + Simd::broadcast<T>(4.67143115e-1f) * x2 };
+    const T q23 { Simd::broadcast<T>(2.58768474e-2f) + Simd::broadcast<T>(3.28557651e-4f) * x2 };
+    const T p { p01 + p23 * x4 + Simd::broadcast<T>(1.33538621e-8f) * x8 };
+    const T q { q01 + q23 * x4 + Simd::broadcast<T>(7.77622768e-7f) * x8 };
+
+    return x * p / q;
+}
+
+}
+
+}
@@ -1,5 +1,6 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "FastMath.h"
 
 static const std::vector<mrta::ParameterInfo> ParameterInfos
 {
@@ -10,6 +11,7 @@ static const std::vector<mrta::ParameterInfo> ParameterInfos
     { Param::ID::Mode,           Param::Name::Mode,      { "LPF12", "HPF12", "BPF12", "LPF24", "HPF24", "BPF24" }, 3 },
     { Param::ID::PostGain,       Param::Name::PostGain,  "dB", 0.0f, -60.f, 12.f, 0.1f, 3.8018f },
     { Param::ID::ModulationFreq, Param::Name::ModulationFreq, "Hz", 30.0f, 0.1f, 2000.0f, 0.1f, 0.3f },
+    { Param::ID::FastMath,       Param::Name::FastMath,  "Off", "On", false },
     
 };
 
@@ -73,6 +75,13 @@ MainProcessor::MainProcessor() :
         DBG(Param::Name::ModulationFreq + juce::String(value));
         modulationFreqHz = value;
     });
+
+    parameterManager.registerParameterCallback(Param::ID::FastMath,
+    [this] (float value, bool /*forced*/)
+    {
+        DBG(Param::Name::FastMath + ": " + juce::String { value });
+        useFastMath = (value > 0.5f);
+    });
 }
 
 MainProcessor::~MainProcessor()
@@ -128,7 +137,9 @@ void MainProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuf
                 //channelData[sample] *= modSignal;
                 float inSample = channelData[sample];
 
-                float diodeMod =
+                float diodeMod = useFastMath ?
+                    DSP::FastMath::tanh(diodeSaturationAmount * (inSample + modSignal)) -
+                    DSP::FastMath::tanh(diodeSaturationAmount * (inSample - modSignal)) :
                     std::tanh(diodeSaturationAmount * (inSample + modSignal)) -
                     std::tanh(diodeSaturationAmount * (inSample - modSignal));
 
@@ -14,6 +14,7 @@ namespace Param
         static const juce::String PostGain { "post_gain" };
 
         static const juce::String ModulationFreq { "modulation_freq" };
+        static const juce::String FastMath { "fast_math" };
 
     }
 
@@ -27,6 +28,7 @@ namespace Param
         static const juce::String PostGain { "Post-Gain" };
 
         static const juce::String ModulationFreq { "Modulation Frequency" };
+        static const juce::String FastMath { "Fast Math" };
 
     }
 }
@@ -73,6 +75,7 @@ private:
     double currentSampleRate = 44100.0;
     bool isEnabled = true;
     float diodeSaturationAmount = 1.5f;
+    bool useFastMath = false; // diode tanh on DSP::FastMath instead of std::tanh
 
     juce::dsp::ProcessorDuplicator<
         juce::dsp::IIR::Filter<float>,
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace DSP
+{
+
+// 32 bit phase accumulator shared by the oscillators and LFOs
+// A full cycle is 2^32 steps, so the phase wraps by itself and the increment is exact
+namespace Phase
+{
+
+constexpr double StepsPerCycle { 4294967296.0 };
+
+// Bipolar ramp units per phase step, 2 / 2^32
+constexpr float BipolarStep { 4.65661287e-10f };
+
+// Increment per sample of a phase running at frequency, at most half a cycle
+inline std::uint32_t increment(double frequency, double sampleRate)
+{
+    const double cyclesPerSample { std::min(frequency / sampleRate, 0.5) };
+    return static_cast<std::uint32_t>(std::llround(cyclesPerSample * StepsPerCycle));
+}
+
+// Phase of a fraction of the cycle, wrapped to [0, 1)
+inline std::uint32_t fromCycles(double cycles)
+{
+    return static_cast<std::uint32_t>(static_cast<std::uint64_t>((cycles - std::floor(cycles)) * StepsPerCycle));
+}
+
+// Rising ramp from -1 at the cycle start up to 1
+// Flipping the top bit moves the wrap of the signed phase to the cycle start
+inline float bipolar(std::uint32_t phase)
+{
+    return static_cast<float>(static_cast<std::int32_t>(phase ^ 0x80000000u)) * BipolarStep;
+}
+
+}
+
+}
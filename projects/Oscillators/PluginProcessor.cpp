@@ -6,6 +6,7 @@ static const std::vector<mrta::ParameterInfo> parameters
 {
     { Param::ID::OscType, Param::Name::OscType, Param::Range::OscTypeLabels, 0 },
     { Param::ID::OscRate, Param::Name::OscRate, Param::Unit::Hz, 440.f, Param::Range::OscRateMin, Param::Range::OscRateMax, Param::Range::OscRateInc, Param::Range::OscRateSkw },
+    { Param::ID::PulseWidth, Param::Name::PulseWidth, Param::Unit::Percent, 25.f, Param::Range::PulseWidthMin, Param::Range::PulseWidthMax, Param::Range::PulseWidthInc, Param::Range::PulseWidthSkw },
     { Param::ID::Volume,  Param::Name::Volume,  Param::Unit::dB, -12.f, Param::Range::VolumeMin,  Param::Range::VolumeMax,  Param::Range::VolumeInc,  Param::Range::VolumeSkw },
 };
 
@@ -27,6 +28,13 @@ OscillatorsAudioProcessor::OscillatorsAudioProcessor() :
         oscRight.setType(type);
     });
 
+    parameterManager.registerParameterCallback(Param::ID::PulseWidth,
+    [this] (float value, bool /*force*/)
+    {
+        oscLeft.setPulseWidth(0.01f * value);
+        oscRight.setPulseWidth(0.01f * value);
+    });
+
     parameterManager.registerParameterCallback(Param::ID::Volume,
     [this] (float value, bool force)
     {
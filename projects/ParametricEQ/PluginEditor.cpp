@@ -16,23 +16,67 @@ ParametricEQAudioProcessorEditor::ParametricEQAudioProcessorEditor(ParametricEQA
 
     band0ParameterEditor.setLookAndFeel(&laf);
 
-    setSize(NumOfBands * BandWidth, ParamsPerBand * ParamHeight);
+    // Log spaced over the band frequency range
+    std::vector<float> responseFrequencies(NumResponsePoints);
+    for (int p = 0; p < NumResponsePoints; ++p)
+        responseFrequencies[p] = Param::Ranges::FreqMin * std::pow(Param::Ranges::FreqMax / Param::Ranges::FreqMin,
+                                                                   static_cast<float>(p) / static_cast<float>(NumResponsePoints - 1));
+
+    audioProcessor.getEqualizer().setResponseFrequencies(responseFrequencies.data(), NumResponsePoints);
+
+    setSize(NumOfBands * BandWidth, ResponseHeight + ParamsPerBand * ParamHeight);
+    startTimerHz(30);
 }
 
 ParametricEQAudioProcessorEditor::~ParametricEQAudioProcessorEditor()
 {
+    stopTimer();
     band0ParameterEditor.setLookAndFeel(nullptr);
 }
 
 void ParametricEQAudioProcessorEditor::paint (juce::Graphics& g)
 {
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+
+    const auto& response { audioProcessor.getEqualizer().getMagnitudeResponse() };
+    if (response.empty())
+        return;
+
+    const auto bounds { responseBounds.toFloat().reduced(10.f) };
+    auto toY = [&bounds] (float db)
+    {
+        return juce::jmap(juce::jlimit(Param::Ranges::GainMin, Param::Ranges::GainMax, db),
+                          Param::Ranges::GainMin, Param::Ranges::GainMax, bounds.getBottom(), bounds.getY());
+    };
+
+    g.setColour(juce::Colours::grey);
+    g.drawHorizontalLine(juce::roundToInt(toY(0.f)), bounds.getX(), bounds.getRight());
+
+    juce::Path curve;
+    for (size_t p = 0; p < response.size(); ++p)
+    {
+        const float x { juce::jmap(static_cast<float>(p), 0.f, static_cast<float>(response.size() - 1), bounds.getX(), bounds.getRight()) };
+        if (p == 0)
+            curve.startNewSubPath(x, toY(response[p]));
+        else
+            curve.lineTo(x, toY(response[p]));
+    }
+
+    g.setColour(juce::Colours::white);
+    g.strokePath(curve, juce::PathStrokeType(2.f));
 }
 
 void ParametricEQAudioProcessorEditor::resized()
 {
     auto localBounds { getLocalBounds() };
+    responseBounds = localBounds.removeFromTop(ResponseHeight);
     band0ParameterEditor.setBounds(localBounds.removeFromLeft(BandWidth));
     band1ParameterEditor.setBounds(localBounds.removeFromLeft(BandWidth));
     band2ParameterEditor.setBounds(localBounds);
+}
+
+void ParametricEQAudioProcessorEditor::timerCallback()
+{
+    if (audioProcessor.getEqualizer().updateResponse())
+        repaint(responseBounds);
 }
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include "PluginProcessor.h"
 #include "MrtaLAF.h"
 
-class ParametricEQAudioProcessorEditor  : public juce::AudioProcessorEditor
+class ParametricEQAudioProcessorEditor  : public juce::AudioProcessorEditor, private juce::Timer
 {
 public:
     ParametricEQAudioProcessorEditor (ParametricEQAudioProcessor&);
@@ -17,6 +17,8 @@ public:
     static const int ParamHeight { 80 };
     static const int ParamsPerBand { 4 };
     static const int NumOfBands { 3 };
+    static const int ResponseHeight { 200 };
+    static const int NumResponsePoints { 256 };
 
 private:
     ParametricEQAudioProcessor& audioProcessor;
@@ -26,5 +28,10 @@ private:
 
     GUI::MrtaLAF laf;
 
+    juce::Rectangle<int> responseBounds;
+
+    // Repaint the response curve when the equalizer reports a change
+    void timerCallback() override;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParametricEQAudioProcessorEditor)
 };
\ No newline at end of file
@@ -17,6 +17,8 @@ static std::vector<mrta::ParameterInfo> parameters
     { Param::ID::Band2Freq, Param::Name::Band2Freq, Param::Unit::Freq, 10000.f, Param::Ranges::FreqMin, Param::Ranges::FreqMax, Param::Ranges::FreqInc, Param::Ranges::FreqSkw },
     { Param::ID::Band2Reso, Param::Name::Band2Reso, "", 0.71f, Param::Ranges::ResoMin, Param::Ranges::ResoMax, Param::Ranges::ResoInc, Param::Ranges::ResoSkw },
     { Param::ID::Band2Gain, Param::Name::Band2Gain, Param::Unit::Gain, 0.f, Param::Ranges::GainMin, Param::Ranges::GainMax, Param::Ranges::GainInc, Param::Ranges::GainSkw },
+
+    { Param::ID::LinearPhase, Param::Name::LinearPhase, Param::Ranges::LinearPhaseOff, Param::Ranges::LinearPhaseOn, false },
 };
 
 ParametricEQAudioProcessor::ParametricEQAudioProcessor() :
@@ -94,10 +96,30 @@ ParametricEQAudioProcessor::ParametricEQAudioProcessor() :
     {
         eq.setBandGain(2, val);
     });
+
+    parameterManager.registerParameterCallback(Param::ID::LinearPhase,
+    [this] (float val, bool /*force*/)
+    {
+        // The equalizer crossfades the switch, the new latency is only stored here and
+        // reported by timerCallback, as setLatencySamples is not realtime safe
+        const bool linearPhase { val > 0.5f };
+        eq.setRealization(linearPhase ? DSP::ParametricEqualizer::LinearPhase : DSP::ParametricEqualizer::Cascade);
+        pendingLatency.store(linearPhase ? static_cast<int>(eq.getLinearPhaseLatency()) : 0, std::memory_order_relaxed);
+    });
+
+    startTimerHz(LatencyCheckHz);
 }
 
 ParametricEQAudioProcessor::~ParametricEQAudioProcessor()
 {
+    stopTimer();
+}
+
+void ParametricEQAudioProcessor::timerCallback()
+{
+    const int latency { pendingLatency.load(std::memory_order_relaxed) };
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
 }
 
 
@@ -105,6 +127,13 @@ void ParametricEQAudioProcessor::prepareToPlay(double sampleRate, int /*samplesP
 {
     unsigned int maxNumChannels = std::max(getMainBusNumInputChannels(), getMainBusNumOutputChannels());
     eq.prepare(sampleRate, maxNumChannels);
+
+    // About 170 ms of FIR, enough resolution for the lowest band frequency
+    unsigned int firLength { 1 };
+    while (firLength < static_cast<unsigned int>(sampleRate * 0.17))
+        firLength *= 2;
+    eq.prepareLinearPhase(firLength - 1, LinearPhaseBlockSize);
+
     parameterManager.updateParameters(true);
 }
 
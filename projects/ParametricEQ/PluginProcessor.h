@@ -22,6 +22,8 @@ namespace Param
         static const juce::String Band2Freq { "band2_freq" };
         static const juce::String Band2Reso { "band2_reso" };
         static const juce::String Band2Gain { "band2_gain" };
+
+        static const juce::String LinearPhase { "linear_phase" };
     }
 
     namespace Name
@@ -40,6 +42,8 @@ namespace Param
         static const juce::String Band2Freq { "B2 Frequency" };
         static const juce::String Band2Reso { "B2 Resonance" };
         static const juce::String Band2Gain { "B2 Gain" };
+
+        static const juce::String LinearPhase { "Linear Phase" };
     }
 
     namespace Ranges
@@ -60,6 +64,9 @@ namespace Param
         static const float GainSkw { 1.f };
 
         static const juce::StringArray Types { "Flat", "High Pass", "Low Shelf", "Peak", "Low Pass", "High Shelf" };
+
+        static const juce::String LinearPhaseOff { "Off" };
+        static const juce::String LinearPhaseOn { "On" };
     }
 
     namespace Unit
@@ -69,7 +76,8 @@ namespace Param
     }
 }
 
-class ParametricEQAudioProcessor : public juce::AudioProcessor
+class ParametricEQAudioProcessor : public juce::AudioProcessor,
+                                   private juce::Timer
 {
 public:
     ParametricEQAudioProcessor();
@@ -84,6 +92,7 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
 
     mrta::ParameterManager& getParamterManager() { return parameterManager; }
+    DSP::ParametricEqualizer& getEqualizer() { return eq; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -101,8 +110,16 @@ public:
     //==============================================================================
 
 private:
+    static const unsigned int LinearPhaseBlockSize { 512 };
+
     mrta::ParameterManager parameterManager;
     DSP::ParametricEqualizer eq;
 
+    // Latency to report, set by the audio thread and compared against the
+    // reported one by a message thread timer
+    std::atomic<int> pendingLatency { 0 };
+    static const int LatencyCheckHz { 10 };
+    void timerCallback() override;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParametricEQAudioProcessor)
 };
\ No newline at end of file
@@ -1,166 +1,548 @@
 #include "DelayLine.h"
+#include "Simd.h"
 
 #include <algorithm>
 #include <cmath>
+#include <memory>
+
+// Long lines live in anonymous virtual memory mappings where the platform has them
+// Define DSP_DELAY_LINE_FORCE_HEAP to keep every line on the heap
+#if !defined(DSP_DELAY_LINE_FORCE_HEAP) && (defined(__linux__) || defined(__APPLE__))
+    #include <sys/mman.h>
+    #define DSP_DELAY_LINE_MAPPED 1
+#elif !defined(DSP_DELAY_LINE_FORCE_HEAP) && defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+    #define DSP_DELAY_LINE_MAPPED 1
+#endif
 
 namespace DSP
 {
 
-DelayLine::DelayLine(unsigned int maxLengthSamples, unsigned int numChannels)
+namespace
 {
-    for (unsigned int ch = 0; ch < numChannels; ++ch)
-        delayBuffer.emplace_back(maxLengthSamples, 0.f);
+    // Interpolation kernels, written once for a single sample (float) and for Simd::Lanes samples (Float4)
+    // x0 is the sample at the integer delay, xm1 the one after it, x1 and x2 the ones before,
+    // t is the fractional delay from x0 towards x1
+
+    template<typename T>
+    T linear(const T& x0, const T& x1, const T& t)
+    {
+        return x0 * (Simd::broadcast<T>(1.f) - t) + x1 * t;
+    }
+
+    template<typename T>
+    T hermite(const T& xm1, const T& x0, const T& x1, const T& x2, const T& t)
+    {
+        const T half { Simd::broadcast<T>(0.5f) };
+        const T c1 { half * (x1 - xm1) };
+        const T c2 { xm1 - Simd::broadcast<T>(2.5f) * x0 + (x1 + x1) - half * x2 };
+        const T c3 { half * (x2 - xm1) + Simd::broadcast<T>(1.5f) * (x0 - x1) };
+        return ((c3 * t + c2) * t + c1) * t + x0;
+    }
+
+    template<typename T>
+    T lagrange(const T& xm1, const T& x0, const T& x1, const T& x2, const T& t)
+    {
+        const T one { Simd::broadcast<T>(1.f) };
+        const T tp1 { t + one };
+        const T tm1 { t - one };
+        const T tm2 { tm1 - one };
+        const T p01 { tp1 * t };
+        const T p23 { tm1 * tm2 };
+        const T sixth { Simd::broadcast<T>(1.f / 6.f) };
+        const T half { Simd::broadcast<T>(0.5f) };
+        return (x2 * p01 * tm1 - xm1 * t * p23) * sixth + (x0 * tp1 * p23 - x1 * p01 * tm2) * half;
+    }
+
+    // Allpass coeff for a fractional delay d, kept in [ThiranMinDelay, ThiranMinDelay + 1)
+    // where the first order allpass is stable and its delay closest to flat
+    template<typename T>
+    T thiranCoeff(const T& d)
+    {
+        const T one { Simd::broadcast<T>(1.f) };
+        return (one - d) / (one + d);
+    }
+
+    constexpr float ThiranMinDelay { 0.5f };
+
+    // Map zero filled virtual memory, a page only becomes resident once it is written
+    // return null if mapping is not available or failed
+    float* mapPages(std::size_t bytes)
+    {
+#if defined(DSP_DELAY_LINE_MAPPED) && defined(_WIN32)
+        return static_cast<float*>(VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+#elif defined(DSP_DELAY_LINE_MAPPED)
+        void* pages { mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) };
+        return pages == MAP_FAILED ? nullptr : static_cast<float*>(pages);
+#else
+        (void)bytes;
+        return nullptr;
+#endif
+    }
+
+    void unmapPages(float* pages, std::size_t bytes)
+    {
+#if defined(DSP_DELAY_LINE_MAPPED) && defined(_WIN32)
+        (void)bytes;
+        VirtualFree(pages, 0, MEM_RELEASE);
+#elif defined(DSP_DELAY_LINE_MAPPED)
+        munmap(pages, bytes);
+#else
+        (void)pages;
+        (void)bytes;
+#endif
+    }
+
+    // Zero mapped pages by handing them back to the system, never by writing zeros over them,
+    // so they only become resident again once written
+    // return false if that failed, the pages must then be unmapped and mapped again
+    bool discardPages(float* pages, std::size_t bytes)
+    {
+#if defined(DSP_DELAY_LINE_MAPPED) && defined(_WIN32)
+        if (!VirtualFree(pages, bytes, MEM_DECOMMIT))
+            return false;
+
+        return VirtualAlloc(pages, bytes, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#elif defined(DSP_DELAY_LINE_MAPPED) && defined(__linux__)
+        // Private anonymous pages read as zeros after MADV_DONTNEED
+        return madvise(pages, bytes, MADV_DONTNEED) == 0;
+#elif defined(DSP_DELAY_LINE_MAPPED)
+        // Elsewhere MADV_DONTNEED may keep the old contents, fresh zero pages are mapped over them instead
+        return mmap(pages, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != MAP_FAILED;
+#else
+        (void)pages;
+        (void)bytes;
+        return false;
+#endif
+    }
+}
+
+DelayLine::DelayLine(unsigned int maxLengthSamples, unsigned int numChannels, Layout storageLayout) :
+    layout { storageLayout }
+{
+    allocate(maxLengthSamples, numChannels);
 }
 
 DelayLine::~DelayLine()
 {
+    if (mappedStorage != nullptr)
+        unmapPages(mappedStorage, mappedBytes);
 }
 
 void DelayLine::clear()
 {
-    for (auto& b : delayBuffer)
-        std::fill(b.begin(), b.end(), 0.f);
+    if (mappedStorage == nullptr)
+    {
+        std::fill(storage.begin(), storage.end(), 0.f);
+    }
+    else if (!discardPages(mappedStorage, mappedBytes))
+    {
+        // Lost pages are replaced by new storage
+        unmapPages(mappedStorage, mappedBytes);
+        mappedStorage = nullptr;
+        mappedBytes = 0;
+        allocate(maxLength, allocatedChannels);
+    }
+
+    std::fill(allpassStates.begin(), allpassStates.end(), 0.f);
 }
 
 void DelayLine::prepare(unsigned int maxLengthSamples, unsigned int numChannels)
 {
-    delayBuffer.clear();
-    for (unsigned int ch = 0; ch < numChannels; ++ch)
-        delayBuffer.emplace_back(maxLengthSamples, 0.f);
+    allocate(maxLengthSamples, numChannels);
 }
 
 void DelayLine::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
 {
-    const unsigned int delayBufferSize { static_cast<unsigned int>(delayBuffer[0].size()) };
-
-    numChannels = std::min(numChannels, static_cast<unsigned int>(delayBuffer.size()));
+    numChannels = std::min(numChannels, allocatedChannels);
     for (unsigned int ch = 0; ch < numChannels; ++ch)
     {
+        float* buffer { delayBuffer + ch * channelStride };
+
         unsigned int workingWriteIndex { writeIndex };
-        unsigned int workingReadIndex { (workingWriteIndex + delayBufferSize - delaySamples) % delayBufferSize };
+        unsigned int workingReadIndex { (workingWriteIndex - delaySamples) & bufferMask };
 
-        for (unsigned int n = 0; n < numSamples; ++n)
+        // Input is written before the output is read, so processing can be in place
+        // Pieces are short enough for the writes to never reach samples still to be read
+        unsigned int n { 0 };
+        while (n < numSamples)
         {
-            const float x { input[ch][n] };
-            output[ch][n] = delayBuffer[ch][workingReadIndex];
-            delayBuffer[ch][workingWriteIndex] = x;
-
-            ++workingWriteIndex; workingWriteIndex %= delayBufferSize;
-            ++workingReadIndex; workingReadIndex %= delayBufferSize;
+            const unsigned int pieceSize { std::min(numSamples - n, bufferSize - delaySamples) };
+
+            for (unsigned int done = 0; done < pieceSize;)
+            {
+                const unsigned int length { std::min(pieceSize - done, bufferSize - workingWriteIndex) };
+                const float* source { input[ch] + n + done };
+                float* destination { buffer + workingWriteIndex * frameStride };
+                if (frameStride == 1)
+                    std::copy(source, source + length, destination);
+                else
+                    for (unsigned int i = 0; i < length; ++i)
+                        destination[i * frameStride] = source[i];
+
+                workingWriteIndex = (workingWriteIndex + length) & bufferMask;
+                done += length;
+            }
+
+            for (unsigned int i = 0; i < GuardSamples; ++i)
+                buffer[(bufferSize + i) * frameStride] = buffer[i * frameStride];
+
+            for (unsigned int done = 0; done < pieceSize;)
+            {
+                const unsigned int length { std::min(pieceSize - done, bufferSize - workingReadIndex) };
+                const float* source { buffer + workingReadIndex * frameStride };
+                float* destination { output[ch] + n + done };
+                if (frameStride == 1)
+                    std::copy(source, source + length, destination);
+                else
+                    for (unsigned int i = 0; i < length; ++i)
+                        destination[i] = source[i * frameStride];
+
+                workingReadIndex = (workingReadIndex + length) & bufferMask;
+                done += length;
+            }
+
+            n += pieceSize;
         }
     }
 
-    writeIndex += numSamples; writeIndex %= delayBufferSize;
+    writeIndex = (writeIndex + numSamples) & bufferMask;
 }
 
 void DelayLine::process(float* output, const float* input, unsigned int numChannels)
 {
-    const unsigned int delayBufferSize{ static_cast<unsigned int>(delayBuffer[0].size()) };
+    numChannels = std::min(numChannels, allocatedChannels);
 
-    numChannels = std::min(numChannels, static_cast<unsigned int>(delayBuffer.size()));
-
-    unsigned int workingWriteIndex { writeIndex };
-    unsigned int workingReadIndex { (workingWriteIndex + delayBufferSize - delaySamples) % delayBufferSize };
+    const unsigned int workingReadIndex { (writeIndex - delaySamples) & bufferMask };
 
     for (unsigned int ch = 0; ch < numChannels; ++ch)
     {
+        float* buffer { delayBuffer + ch * channelStride };
         const float x { input[ch] };
-        output[ch] = delayBuffer[ch][workingReadIndex];
-        delayBuffer[ch][workingWriteIndex] = x;
+        output[ch] = buffer[workingReadIndex * frameStride];
+        write(buffer, writeIndex, x);
     }
 
-    ++writeIndex; writeIndex %= delayBufferSize;
+    writeIndex = (writeIndex + 1u) & bufferMask;
 }
 
 void DelayLine::process(float* const* audioOutput, const float* const* audioInput, const float* const* modInput, unsigned int numChannels, unsigned int numSamples)
 {
-    const unsigned int delayBufferSize{ static_cast<unsigned int>(delayBuffer[0].size()) };
+    numChannels = std::min(numChannels, allocatedChannels);
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        processModulatedChannel(ch, audioOutput[ch], audioInput[ch], modInput[ch], numSamples);
 
-    numChannels = std::min(numChannels, static_cast<unsigned int>(delayBuffer.size()));
+    // Update persistent write index
+    writeIndex = (writeIndex + numSamples) & bufferMask;
+}
+
+void DelayLine::read(float* const* audioOutput, const float* const* modInput, unsigned int numChannels, unsigned int numSamples)
+{
+    // Without input nothing is written and the write index stays for the following write
+    numChannels = std::min(numChannels, allocatedChannels);
     for (unsigned int ch = 0; ch < numChannels; ++ch)
-    {
-        // Calculate base indices based on fixed delay time
-        unsigned int workingWriteIndex { writeIndex };
-        unsigned int workingReadIndex { (workingWriteIndex + delayBufferSize - delaySamples) % delayBufferSize };
+        processModulatedChannel(ch, audioOutput[ch], nullptr, modInput[ch], numSamples);
+}
 
-        for (unsigned int n = 0; n < numSamples; ++n)
-        {
-            // Linear interpolation coefficients
-            const float m { std::fmax(modInput[ch][n], 0.f) };
-            const float mFloor { std::floor(m) };
-            const float mFrac0 { m - mFloor };
-            const float mFrac1 { 1.f - mFrac0 };
+void DelayLine::process(float* audioOutput, const float* audioInput, const float* modInput, unsigned int numChannels)
+{
+    // Calculate base indices based on fixed delay time
+    const unsigned int workingReadIndex { (writeIndex - delaySamples) & bufferMask };
 
-            // Calculate read indices
-            const unsigned int readIndex0 { (workingReadIndex + delayBufferSize - static_cast<unsigned int>(mFloor)) % delayBufferSize };
-            const unsigned int readIndex1 { (readIndex0 + delayBufferSize - 1u) % delayBufferSize };
+    numChannels = std::min(numChannels, allocatedChannels);
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        float* buffer { delayBuffer + ch * channelStride };
 
-            // Read from delay line
-            const float read0 = delayBuffer[ch][readIndex0];
-            const float read1 = delayBuffer[ch][readIndex1];
+        // Write input
+        write(buffer, writeIndex, audioInput[ch]);
 
-            // Read audio input
-            const float x { audioInput[ch][n] };
+        // Interpolate output
+        audioOutput[ch] = readInterpolated(buffer, workingReadIndex, modInput[ch], allpassStates[ch]);
+    }
 
-            // Interpolate output
-            audioOutput[ch][n] = read0 * mFrac1 + read1 * mFrac0;
+    // Update persistent write index
+    writeIndex = (writeIndex + 1u) & bufferMask;
+}
 
-            // Write input
-            delayBuffer[ch][workingWriteIndex] = x;
+void DelayLine::write(const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    numChannels = std::min(numChannels, allocatedChannels);
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        float* buffer { delayBuffer + ch * channelStride };
 
-            // Increament indices
-            ++workingWriteIndex; workingWriteIndex %= delayBufferSize;
-            ++workingReadIndex; workingReadIndex %= delayBufferSize;
+        unsigned int workingWriteIndex { writeIndex };
+        for (unsigned int done = 0; done < numSamples;)
+        {
+            const unsigned int length { std::min(numSamples - done, bufferSize - workingWriteIndex) };
+            const float* source { input[ch] + done };
+            float* destination { buffer + workingWriteIndex * frameStride };
+            if (frameStride == 1)
+                std::copy(source, source + length, destination);
+            else
+                for (unsigned int i = 0; i < length; ++i)
+                    destination[i * frameStride] = source[i];
+
+            workingWriteIndex = (workingWriteIndex + length) & bufferMask;
+            done += length;
         }
+
+        for (unsigned int i = 0; i < GuardSamples; ++i)
+            buffer[(bufferSize + i) * frameStride] = buffer[i * frameStride];
     }
 
-    // Update persistent write index
-    writeIndex += numSamples; writeIndex %= delayBufferSize;
+    writeIndex = (writeIndex + numSamples) & bufferMask;
 }
 
-void DelayLine::process(float* audioOutput, const float* audioInput, const float* modInput, unsigned int numChannels)
+void DelayLine::setDelaySamples(unsigned int newDelaySamples)
 {
-    const unsigned int delayBufferSize{ static_cast<unsigned int>(delayBuffer[0].size()) };
+    delaySamples = std::max(std::min(newDelaySamples, maxLength - 1u), 1u);
+}
 
-    // Calculate base indices based on fixed delay time
-    unsigned int workingWriteIndex { writeIndex };
-    unsigned int workingReadIndex { (workingWriteIndex + delayBufferSize - delaySamples) % delayBufferSize };
+void DelayLine::setInterpolation(Interpolation newInterpolation)
+{
+    interpolation = newInterpolation;
+    std::fill(allpassStates.begin(), allpassStates.end(), 0.f);
+}
 
-    numChannels = std::min(numChannels, static_cast<unsigned int>(delayBuffer.size()));
-    for (unsigned int ch = 0; ch < numChannels; ++ch)
+void DelayLine::allocate(unsigned int maxLengthSamples, unsigned int numChannels)
+{
+    maxLength = std::max(maxLengthSamples, 2u);
+
+    bufferSize = 1;
+    while (bufferSize < maxLength)
+        bufferSize *= 2;
+
+    bufferMask = bufferSize - 1u;
+    writeIndex = 0;
+    delaySamples = std::max(std::min(delaySamples, maxLength - 1u), 1u);
+
+    // Planar channels are padded to whole cache lines so every channel starts aligned
+    const unsigned int floatsPerLine { CacheLineSize / static_cast<unsigned int>(sizeof(float)) };
+    const unsigned int channelLength { bufferSize + GuardSamples };
+    allocatedChannels = numChannels;
+    allpassStates.assign(numChannels, 0.f);
+
+    if (layout == Planar)
     {
-        // Linear interpolation coefficients
-        const float m { std::fmax(modInput[ch], 0.f) };
-        const float mFloor { std::floor(m) };
-        const float mFrac0 { m - mFloor };
-        const float mFrac1 { 1.f - mFrac0 };
+        channelStride = (channelLength + floatsPerLine - 1u) / floatsPerLine * floatsPerLine;
+        frameStride = 1;
+    }
+    else
+    {
+        channelStride = 1;
+        frameStride = numChannels;
+    }
 
-        // Calculate read indeces
-        const unsigned int readIndex0 { (workingReadIndex + delayBufferSize - static_cast<unsigned int>(mFloor)) % delayBufferSize };
-        const unsigned int readIndex1 { (readIndex0 + delayBufferSize - 1u) % delayBufferSize };
+    const std::size_t usedSize { static_cast<std::size_t>(layout == Planar ? channelStride : channelLength) * numChannels };
+    const std::size_t usedBytes { usedSize * sizeof(float) };
 
-        // Read from delay line
-        const float read0 = delayBuffer[ch][readIndex0];
-        const float read1 = delayBuffer[ch][readIndex1];
+    // Long lines map their storage, page aligned and zero without being written
+    if (usedBytes >= MappedStorageMinBytes)
+    {
+        if (mappedStorage == nullptr || mappedBytes < usedBytes || !discardPages(mappedStorage, mappedBytes))
+        {
+            if (mappedStorage != nullptr)
+                unmapPages(mappedStorage, mappedBytes);
 
-        // Read audio input
-        const float x { audioInput[ch] };
+            mappedStorage = mapPages(usedBytes);
+            mappedBytes = mappedStorage != nullptr ? usedBytes : 0;
+        }
 
-        // Interpolate output
-        audioOutput[ch] = read0 * mFrac1 + read1 * mFrac0;
+        if (mappedStorage != nullptr)
+        {
+            storage = std::vector<float>();
+            delayBuffer = mappedStorage;
+            return;
+        }
+    }
+    else if (mappedStorage != nullptr)
+    {
+        unmapPages(mappedStorage, mappedBytes);
+        mappedStorage = nullptr;
+        mappedBytes = 0;
+    }
 
-        // Write input
-        delayBuffer[ch][workingWriteIndex] = x;
+    // Shrinking or refilling keeps the capacity, only growing past it allocates
+    storage.resize(usedSize + floatsPerLine);
+    std::fill(storage.begin(), storage.end(), 0.f);
+
+    void* alignedData { storage.data() };
+    std::size_t space { storage.size() * sizeof(float) };
+    delayBuffer = static_cast<float*>(std::align(CacheLineSize, usedBytes, alignedData, space));
+}
+
+float DelayLine::getMaxModulation() const
+{
+    // The oldest tap of the first sample of a group must not be overwritten by the group
+    return static_cast<float>(std::max(static_cast<int>(bufferSize) - 6 - static_cast<int>(delaySamples), 0));
+}
+
+void DelayLine::write(float* buffer, unsigned int index, float x)
+{
+    buffer[index * frameStride] = x;
+    if (index < GuardSamples)
+        buffer[(bufferSize + index) * frameStride] = x;
+}
+
+float DelayLine::readInterpolated(const float* buffer, unsigned int readIndex, float m, float& allpassState) const
+{
+    m = std::fmin(std::fmax(m, 0.f), getMaxModulation());
+    const float mFloor { std::floor(m) };
+    const float t { m - mFloor };
+
+    // Taps from the oldest, the guard keeps all four contiguous
+    const unsigned int base { (readIndex - static_cast<unsigned int>(mFloor) - 2u) & bufferMask };
+    const float* taps { buffer + base * frameStride };
+
+    switch (interpolation)
+    {
+    case Hermite:
+        return hermite(taps[3u * frameStride], taps[2u * frameStride], taps[frameStride], taps[0], t);
+
+    case Lagrange:
+        return lagrange(taps[3u * frameStride], taps[2u * frameStride], taps[frameStride], taps[0], t);
+
+    case Thiran:
+    {
+        const bool useNewer { t < ThiranMinDelay };
+        const float x0 { useNewer ? taps[3u * frameStride] : taps[2u * frameStride] };
+        const float x1 { useNewer ? taps[2u * frameStride] : taps[frameStride] };
+        const float a { thiranCoeff(useNewer ? t + 1.f : t) };
+        allpassState = a * x0 + x1 - a * allpassState;
+        return allpassState;
     }
 
-    // Update persistent write index
-    ++writeIndex; writeIndex %= delayBufferSize;
+    case Linear:
+    default:
+        return linear(taps[2u * frameStride], taps[frameStride], t);
+    }
 }
 
-void DelayLine::setDelaySamples(unsigned int newDelaySamples)
+void DelayLine::processModulatedChannel(unsigned int channel, float* output, const float* input, const float* mod, unsigned int numSamples)
 {
-    delaySamples = std::max(std::min(newDelaySamples, static_cast<unsigned int>(delayBuffer[0].size() - 1u)), 1u);
+    switch (interpolation)
+    {
+    case Hermite:
+        processModulated<Hermite>(channel, output, input, mod, numSamples);
+        break;
+
+    case Lagrange:
+        processModulated<Lagrange>(channel, output, input, mod, numSamples);
+        break;
+
+    case Thiran:
+        processModulated<Thiran>(channel, output, input, mod, numSamples);
+        break;
+
+    case Linear:
+    default:
+        processModulated<Linear>(channel, output, input, mod, numSamples);
+        break;
+    }
 }
 
+template<DelayLine::Interpolation kernel>
+void DelayLine::processModulated(unsigned int channel, float* output, const float* input, const float* mod, unsigned int numSamples)
+{
+    using Simd::Float4;
+
+    float* buffer { delayBuffer + channel * channelStride };
+    float& allpassState { allpassStates[channel] };
+
+    // Calculate base indices based on fixed delay time
+    unsigned int workingWriteIndex { writeIndex };
+    unsigned int workingReadIndex { (workingWriteIndex - delaySamples) & bufferMask };
+
+    const float maxModulation { getMaxModulation() };
+
+    unsigned int n { 0 };
+    for (; n + Simd::Lanes <= numSamples; n += Simd::Lanes)
+    {
+        // Write input of the whole group first, as the single sample processing would have by its read
+        if (input != nullptr)
+            for (unsigned int l = 0; l < Simd::Lanes; ++l)
+                write(buffer, (workingWriteIndex + l) & bufferMask, input[n + l]);
+
+        // Integer and fractional delay of every sample, oldest tap first
+        const float* taps[Simd::Lanes];
+        float t[Simd::Lanes];
+        for (unsigned int l = 0; l < Simd::Lanes; ++l)
+        {
+            const float m { std::fmin(std::fmax(mod[n + l], 0.f), maxModulation) };
+            const float mFloor { std::floor(m) };
+            t[l] = m - mFloor;
+            taps[l] = buffer + ((workingReadIndex + l - static_cast<unsigned int>(mFloor) - 2u) & bufferMask) * frameStride;
+        }
+
+        // Gather tap k of the four samples
+        const auto tap = [&] (unsigned int k)
+        {
+            return Float4::set(taps[0][k * frameStride], taps[1][k * frameStride], taps[2][k * frameStride], taps[3][k * frameStride]);
+        };
+
+        if constexpr (kernel == Thiran)
+        {
+            // Coeffs of the group at once, the recursion runs sample by sample
+            float d[Simd::Lanes];
+            for (unsigned int l = 0; l < Simd::Lanes; ++l)
+            {
+                if (t[l] < ThiranMinDelay)
+                {
+                    d[l] = t[l] + 1.f;
+                    taps[l] += frameStride;
+                }
+                else
+                {
+                    d[l] = t[l];
+                }
+            }
+
+            float a[Simd::Lanes];
+            thiranCoeff(Float4::load(d)).store(a);
+
+            for (unsigned int l = 0; l < Simd::Lanes; ++l)
+            {
+                allpassState = a[l] * taps[l][2u * frameStride] + taps[l][frameStride] - a[l] * allpassState;
+                output[n + l] = allpassState;
+            }
+        }
+        else
+        {
+            const Float4 frac { Float4::load(t) };
+            Float4 y;
+            if constexpr (kernel == Hermite)
+                y = hermite(tap(3), tap(2), tap(1), tap(0), frac);
+            else if constexpr (kernel == Lagrange)
+                y = lagrange(tap(3), tap(2), tap(1), tap(0), frac);
+            else
+                y = linear(tap(2), tap(1), frac);
+
+            y.store(output + n);
+        }
+
+        // Increment indices
+        workingWriteIndex = (workingWriteIndex + Simd::Lanes) & bufferMask;
+        workingReadIndex = (workingReadIndex + Simd::Lanes) & bufferMask;
+    }
+
+    for (; n < numSamples; ++n)
+    {
+        if (input != nullptr)
+            write(buffer, workingWriteIndex, input[n]);
+
+        output[n] = readInterpolated(buffer, workingReadIndex, mod[n], allpassState);
+
+        workingWriteIndex = (workingWriteIndex + 1u) & bufferMask;
+        workingReadIndex = (workingReadIndex + 1u) & bufferMask;
+    }
+}
 
 }
\ No newline at end of file
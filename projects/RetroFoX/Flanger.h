@@ -1,11 +1,16 @@
 #pragma once
 
 #include "DelayLine.h"
+#include "Lfo.h"
 #include "Ramp.h"
+#include "Simd.h"
 
 namespace DSP
 {
 
+// Modulated delay flanger
+// Audio is processed in chunks: the modulation of a whole chunk is generated first and
+// then runs thru the block flavour of the modulated delay line
 class Flanger
 {
 public:
@@ -50,6 +55,9 @@ public:
     // Set delay time modulation waveform type
     void setModulationType(ModulationType newModType);
 
+    // Set the interpolation of the modulated delay, higher quality kernels cost more CPU
+    void setInterpolation(DelayLine::Interpolation newInterpolation);
+
     static constexpr int MaxChannels { 2 };
 
 private:
@@ -60,14 +68,19 @@ private:
     DSP::Ramp<float> offsetRamp;
     DSP::Ramp<float> modDepthRamp;
 
-    float phaseState[2] { 0.f, 0.f };
-    float phaseInc { 0.f };
+    // Channel 1 runs a quarter cycle behind channel 0
+    DSP::Lfo lfo;
 
     float offsetMs { 0.f };
     float modDepthMs { 0.f };
     float modRate { 0.f };
 
     ModulationType modType { Sin };
+
+    static constexpr unsigned int ChunkSize { 64 };
+
+    // Write the unipolar LFO of every channel for up to ChunkSize samples
+    void generateModulation(float* const* mod, unsigned int numChannels, unsigned int numSamples);
 };
 
 }
\ No newline at end of file
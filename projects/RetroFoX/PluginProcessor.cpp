@@ -32,8 +32,12 @@ MainProcessor::MainProcessor() :
     tremoloEffectEnabled(true), // Default from Parameters vector
     tremoloRateHz(1.0f),        // Default from Parameters vector
     tremoloDepth(0.0f / 100.0f), // Default from Parameters (0.0%) scaled to 0.0-1.0
+    tremoloLFO(1),
 
-    vinylNoiseLevel(0.0f) // <<< NEW: Initialize vinylNoiseLevel
+    vinylNoiseLevel(0.0f), // <<< NEW: Initialize vinylNoiseLevel
+
+    pitchWobbleLFO(1),
+    pitchWobbleDelay(1, MaxChannels)
 
 {
     parameterManager.registerParameterCallback(Param::ID::Drive,
@@ -238,15 +242,10 @@ void MainProcessor::prepareToPlay(double newSampleRate, int samplesPerBlock)
     outputGain.reset(newSampleRate, 0.01f);
 
     // Tremolo
-    juce::dsp::ProcessSpec lfoSpec; // LFO is mono, but prepare with overall spec
-    lfoSpec.sampleRate = newSampleRate;
-    lfoSpec.maximumBlockSize = static_cast<juce::uint32>(samplesPerBlock);
-    lfoSpec.numChannels = 1; // LFO itself processes mono
-    
-    tremoloLFO.prepare(lfoSpec);
-    tremoloLFO.initialise([](float x){ return std::sin(x); }); // Sine wave LFO
-    // Set initial frequency, force phase reset for consistent start
-    tremoloLFO.setFrequency(tremoloRateHz, true); 
+    // Mono sine LFO, prepare resets the phase for a consistent start
+    tremoloLFO.setWaveform(DSP::Lfo::Sin);
+    tremoloLFO.setFrequency(tremoloRateHz);
+    tremoloLFO.prepare(newSampleRate);
 
     // Prepare LFO output buffer
     tremoloLfoOutputBuffer.setSize(1, samplesPerBlock, false, true, false);
@@ -264,32 +263,21 @@ void MainProcessor::prepareToPlay(double newSampleRate, int samplesPerBlock)
     noiseFilter.parameters->setCutOffFrequency(newSampleRate, 3000.0f, static_cast<float>(1.0 / std::sqrt(2.0))); // Cutoff 3kHz, Q ~0.707
 
     // Pitch Wobble
-    juce::dsp::ProcessSpec pitchWobbleLfoSpec;
-    pitchWobbleLfoSpec.sampleRate = newSampleRate;
-    pitchWobbleLfoSpec.maximumBlockSize = static_cast<juce::uint32>(samplesPerBlock);
-    pitchWobbleLfoSpec.numChannels = 1; // Mono LFO
-
-    pitchWobbleLFO.prepare(pitchWobbleLfoSpec);
-    // >>> MODIFIED - Correct LFO initialisation for full cycle
-    pitchWobbleLFO.initialise([](float x) { return std::sin(x * juce::MathConstants<float>::twoPi); }); 
+    // Mono sine LFO, one cycle per period of the rate
     // Initial frequency will be set by parameterManager.updateParameters(true) below
-
-    pitchWobbleDelayLines.resize(numChannels);
-    juce::dsp::ProcessSpec monoDelaySpec; // Spec for each individual mono delay line
-    monoDelaySpec.sampleRate = newSampleRate;
-    monoDelaySpec.maximumBlockSize = static_cast<juce::uint32>(samplesPerBlock);
-    monoDelaySpec.numChannels = 1; // Each dsp::DelayLine is mono
+    pitchWobbleLFO.setWaveform(DSP::Lfo::Sin);
+    pitchWobbleLFO.prepare(newSampleRate);
 
     float maxTotalDelayMs = PITCH_WOBBLE_CENTRAL_DELAY_MS + PITCH_WOBBLE_MAX_MOD_DEPTH_MS + 5.0f; // +5ms safety margin
-    int maxDelaySamples = static_cast<int>(std::ceil(maxTotalDelayMs / 1000.0f * newSampleRate));
-    maxDelaySamples = std::max(maxDelaySamples, samplesPerBlock); // Ensure it can hold at least one block if maxTotalDelayMs is very short
+    unsigned int maxDelaySamples = static_cast<unsigned int>(std::ceil(maxTotalDelayMs / 1000.0f * newSampleRate));
 
-    for (unsigned int ch = 0; ch < numChannels; ++ch)
-    {
-        pitchWobbleDelayLines[ch].prepare(monoDelaySpec);
-        pitchWobbleDelayLines[ch].setMaximumDelayInSamples(maxDelaySamples);
-        pitchWobbleDelayLines[ch].reset();
-    }
+    // Fixed delay of 1 sample, the modulation adds the rest, linear interpolation as the wobble always had
+    pitchWobbleDelay.prepare(maxDelaySamples, numChannels);
+    pitchWobbleDelay.setDelaySamples(1);
+    pitchWobbleDelay.setInterpolation(DSP::DelayLine::Linear);
+    pitchWobbleMod.assign(static_cast<size_t>(std::max(samplesPerBlock, 1)), 0.0f);
+    pitchWobbleModChannels.assign(numChannels, pitchWobbleMod.data());
+    pitchWobbleChannels.assign(numChannels, nullptr);
 
     // Update parameters, set and clear fx buffer
     parameterManager.updateParameters(true);
@@ -304,11 +292,7 @@ void MainProcessor::releaseResources()
     bitCrusher.reset();
     flanger.clear();
     pitchWobbleLFO.reset();
-    for (auto& delayLine : pitchWobbleDelayLines)
-    {
-        delayLine.reset();
-    }
-    pitchWobbleDelayLines.clear();
+    pitchWobbleDelay.clear();
     tremoloLFO.reset(); 
     noiseFilter.reset();
 }
@@ -358,12 +342,10 @@ void MainProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBu
 
         auto* lfoSamples = tremoloLfoOutputBuffer.getWritePointer(0);
 
-        // Generate LFO samples for the block (mono LFO)
+        // Generate LFO samples for the block (mono LFO), outputs -1 to 1
+        tremoloLFO.process(&lfoSamples, 1, numSamples);
         for (int i = 0; i < numSamples; ++i)
-        {
-            float lfoSampleRaw = tremoloLFO.processSample(0.0f); // LFO outputs ~ -1 to 1
-            lfoSamples[i] = (lfoSampleRaw + 1.0f) * 0.5f;      // Scale to 0 to 1
-        }
+            lfoSamples[i] = (lfoSamples[i] + 1.0f) * 0.5f; // Scale to 0 to 1
 
         // Apply tremolo gain to each processing channel
         for (int ch = 0; ch < numChannels; ++ch)
@@ -380,46 +362,40 @@ void MainProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBu
 
     // Pitch wobble
     if (currentPitchWobbleIntensity > 0.001f && 
-        pitchWobbleDelayLines.size() == numChannels && 
+        pitchWobbleModChannels.size() == numChannels && 
         sampleRate > 0.0f)
     {
         // Effective modulation depth in milliseconds for the current intensity
         const float currentMaxDelaySwingMs = currentPitchWobbleIntensity * PITCH_WOBBLE_MAX_MOD_DEPTH_MS;
 
-        for (unsigned int s = 0; s < numSamples; ++s)
+        // Clamp the delay to a safe minimum (e.g., 0.1 ms or 1 sample time)
+        const float minDelayMs = std::max(0.1f, (1.0f / sampleRate) * 1000.0f);
+
+        // Hosts may send blocks longer than announced, so go thru the modulation buffer in chunks
+        const unsigned int chunkSize = static_cast<unsigned int>(pitchWobbleMod.size());
+        for (unsigned int n = 0; n < numSamples; n += chunkSize)
         {
-            // Get LFO sample (advances LFO phase)
-            float lfoValue = pitchWobbleLFO.processSample(0.0f); // Output is ~ -1 to 1 for sine
+            const unsigned int chunkSamples = std::min(numSamples - n, chunkSize);
 
-            // Calculate the delay offset in milliseconds based on LFO and current max swing
-            float delayOffsetMs = lfoValue * currentMaxDelaySwingMs;
+            // LFO of the whole chunk (advances LFO phase), output is -1 to 1 for sine
+            float* lfoSamples = pitchWobbleMod.data();
+            pitchWobbleLFO.process(&lfoSamples, 1, chunkSamples);
 
-            for (unsigned int ch = 0; ch < numChannels; ++ch)
+            for (unsigned int s = 0; s < chunkSamples; ++s)
             {
-                auto& delayLine = pitchWobbleDelayLines[ch];
-                float* channelData = buffer.getWritePointer(static_cast<int>(ch));
-                float inputSample = channelData[s]; // Read current sample from buffer
-
-                // Push current input sample into its respective delay line
-                // 'channel' arg for pushSample/popSample on an individual dsp::DelayLine is 0
-                delayLine.pushSample(0, inputSample);
-
-                // Calculate total target delay for this channel and sample in milliseconds
-                float targetDelayMs = PITCH_WOBBLE_CENTRAL_DELAY_MS + delayOffsetMs;
-
-                // Clamp targetDelayMs to a safe minimum (e.g., 0.1 ms or 1 sample time)
-                const float minDelayMs = std::max(0.1f, (1.0f / sampleRate) * 1000.0f); 
-                targetDelayMs = std::max(minDelayMs, targetDelayMs);
-                
-                // Convert delay from ms to samples for the popSample method
-                float delayInSamples = targetDelayMs * sampleRate / 1000.0f;
-                
-                // Pop the delayed sample (interpolated)
-                float delayedSample = delayLine.popSample(0, delayInSamples, true /*interpolate*/);
-
-                // Write the delayed sample back to the buffer
-                channelData[s] = delayedSample;
+                const float lfoValue = pitchWobbleMod[s];
+
+                // Total target delay in milliseconds based on LFO and current max swing
+                float targetDelayMs = std::max(minDelayMs, PITCH_WOBBLE_CENTRAL_DELAY_MS + lfoValue * currentMaxDelaySwingMs);
+
+                // Convert to samples on top of the fixed 1 sample delay
+                pitchWobbleMod[s] = targetDelayMs * sampleRate / 1000.0f - 1.0f;
             }
+
+            for (unsigned int ch = 0; ch < numChannels; ++ch)
+                pitchWobbleChannels[ch] = buffer.getWritePointer(static_cast<int>(ch), static_cast<int>(n));
+
+            pitchWobbleDelay.process(pitchWobbleChannels.data(), pitchWobbleChannels.data(), pitchWobbleModChannels.data(), numChannels, chunkSamples);
         }
     }
 
@@ -2,7 +2,9 @@
 
 #include <JuceHeader.h>
 #include "Flanger.h"
+#include "DelayLine.h"
 #include "BitCrusher.h"
+#include "Lfo.h"
 
 namespace Param
 {
@@ -151,7 +153,7 @@ private:
     bool enabled { true };
     juce::AudioBuffer<float> fxBuffer;
 
-    juce::dsp::Oscillator<float> tremoloLFO;
+    DSP::Lfo tremoloLFO;
     float tremoloRateHz { 1.0f };         // Current LFO rate
     float tremoloDepth { 0.0f };          // Current depth (0.0 to 1.0)
     bool tremoloEffectEnabled { false };  // Is the tremolo effect active?
@@ -161,8 +163,11 @@ private:
     juce::dsp::StateVariableFilter::Filter<float> noiseFilter; // For shaping the noise
     float vinylNoiseLevel { 0.0f }; // 0.0 to 1.0
 
-    juce::dsp::Oscillator<float> pitchWobbleLFO;
-    std::vector<juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear>> pitchWobbleDelayLines;
+    DSP::Lfo pitchWobbleLFO;
+    DSP::DelayLine pitchWobbleDelay;
+    std::vector<float> pitchWobbleMod; // Delay modulation in samples on top of the 1 sample fixed delay
+    std::vector<const float*> pitchWobbleModChannels; // All channels share the same modulation
+    std::vector<float*> pitchWobbleChannels; // Channel pointers of the chunk being processed
     float currentPitchWobbleIntensity { 0.0f }; // Internal state, 0.0 to 1.0
 
     static constexpr float PITCH_WOBBLE_CENTRAL_DELAY_MS { 15.0f }; // Base delay around which to modulate
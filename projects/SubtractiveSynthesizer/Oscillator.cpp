@@ -1,4 +1,8 @@
 #include "Oscillator.h"
+#include "FastMath.h"
+#include "Phase.h"
+#include "Simd.h"
+
 #include <algorithm>
 #include <cmath>
 
@@ -18,78 +22,45 @@ void Oscillator::prepare(double newSampleRate)
     sampleRate = newSampleRate;
 
     // update phase increment for new sample rate
-    phaseInc = static_cast<float>(1.0 / sampleRate) * frequency;
-
-    differentiatorCoeff = static_cast<float>(sampleRate) / (4.f * frequency * (1.f - frequency / static_cast<float>(sampleRate)));
+    updateIncrement();
 
     // reset states
-    phaseState = 0.f;
+    phaseState = 0;
     differentiatorState = 0.f;
 }
 
 void Oscillator::process(float* output, unsigned int numSamples)
 {
-    for (unsigned int n = 0; n < numSamples; ++n)
-    {
-        switch (type)
-        {
-        case Sin:
-            output[n] = std::sin(static_cast<float>(2.0 * M_PI) * phaseState);
-            break;
-
-        case TriAliased:
-            output[n] = 4.f * std::fabs(phaseState - 0.5f) - 1.f;
-            break;
-
-        case SawAliased:
-            output[n] = 2.f * phaseState - 1.f;
-            break;
-
-        case TriAA:
-            output[n] = dpwTri();
-            break;
-
-        case SawAA:
-            output[n] = dpwSaw();
-            break;
-
-        default: break;
-        }
-
-        phaseState = std::fmod(phaseState + phaseInc, 1.f);
-    }
-}
-
-float Oscillator::process()
-{
-    float osc { 0.f };
-
     switch (type)
     {
     case Sin:
-        osc = std::sin(static_cast<float>(2.0 * M_PI) * phaseState);
+        processBlock<Sin>(output, numSamples);
         break;
 
     case TriAliased:
-        osc = 4.f * std::fabs(phaseState - 0.5f) - 1.f;
+        processBlock<TriAliased>(output, numSamples);
         break;
 
     case SawAliased:
-        osc = 2.f * phaseState - 1.f;
+        processBlock<SawAliased>(output, numSamples);
         break;
 
     case TriAA:
-        osc = dpwTri();
+        processBlock<TriAA>(output, numSamples);
         break;
 
     case SawAA:
-        osc = dpwSaw();
+        processBlock<SawAA>(output, numSamples);
         break;
 
     default: break;
     }
+}
 
-    phaseState = std::fmod(phaseState + phaseInc, 1.f);
+float Oscillator::process()
+{
+    float osc { 0.f };
+    process(&osc, 1);
 
     return osc;
 }
@@ -97,9 +68,7 @@ float Oscillator::process()
 void Oscillator::setFrequency(float freqHz)
 {
     frequency = std::clamp(freqHz, 0.1f, 10000.f);
-
-    phaseInc = static_cast<float>(1.0 / sampleRate) * frequency;
-    differentiatorCoeff = static_cast<float>(sampleRate) / (4.f * frequency * (1.f - frequency / static_cast<float>(sampleRate)));
+    updateIncrement();
 }
 
 void Oscillator::setType(OscType newType)
@@ -107,7 +76,7 @@ void Oscillator::setType(OscType newType)
     type = newType;
 
     // reset states
-    phaseState = 0.f;
+    phaseState = 0;
     differentiatorState = 0.f;
 }
 
@@ -123,42 +92,90 @@ void Oscillator::renderNextBlock (AudioBuffer<double>& outputBuffer,
     subBuffer.makeCopyOf (outputBuffer, true);
 }
 
-float Oscillator::dpwSaw()
+void Oscillator::updateIncrement()
 {
-    // unipolar to bipolar
-    float bipolar = 2.f * phaseState - 1.f;
+    phaseInc = Phase::increment(frequency, sampleRate);
 
-    // power of 2
-    bipolar *= bipolar;
-
-    // diffierentiator
-    float output = bipolar - differentiatorState;
-    differentiatorState = bipolar;
+    differentiatorCoeff = static_cast<float>(sampleRate) / (4.f * frequency * (1.f - frequency / static_cast<float>(sampleRate)));
+}
 
-    // apply compensation coeff and return
-    return output * differentiatorCoeff;
+template<Oscillator::OscType waveform>
+void Oscillator::processBlock(float* output, unsigned int numSamples)
+{
+    for (unsigned int n = 0; n < numSamples; n += ChunkSize)
+        processChunk<waveform>(output + n, std::min(numSamples - n, ChunkSize));
 }
 
-float Oscillator::dpwTri()
+template<Oscillator::OscType waveform>
+void Oscillator::processChunk(float* output, unsigned int numSamples)
 {
-    // unipolar to bipolar
-    float bipolar = 2.f * phaseState - 1.f;
+    using Simd::Float4;
 
-    // power of 2
-    float parabola = bipolar * bipolar;
+    // Whole registers, the samples past numSamples are computed and dropped
+    const unsigned int vectorSamples { (numSamples + Simd::Lanes - 1u) / Simd::Lanes * Simd::Lanes };
 
-    // add 1 offset
-    float offset = 1.f - parabola;
+    // Bipolar phase of every sample, after the last differentiator input of the previous chunk
+    float x[ChunkSize + 1u];
+    x[0] = differentiatorState;
+    for (unsigned int n = 0; n < vectorSamples; ++n)
+        x[n + 1u] = Phase::bipolar(phaseState + phaseInc * n);
 
-    // square wave
-    float square = std::copysign(1.f, bipolar) * offset;
+    phaseState += phaseInc * numSamples;
+
+    const Float4 zero { Float4::broadcast(0.f) };
+    const Float4 one { Float4::broadcast(1.f) };
+    const Float4 coeff { Float4::broadcast(differentiatorCoeff) };
+
+    float y[ChunkSize];
+    for (unsigned int n = 0; n < vectorSamples; n += Simd::Lanes)
+    {
+        const Float4 bipolar { Float4::load(x + n + 1u) };
 
-    // diffierentiator - clip above 0.f to about spike
-    float output = std::fmin(square - differentiatorState, 0.f);
-    differentiatorState = square;
+        if constexpr (waveform == Sin)
+        {
+            // sin(2 pi p) = -sin(pi (2p - 1))
+            (zero - FastMath::sin(Float4::broadcast(static_cast<float>(M_PI)) * bipolar)).store(y + n);
+        }
+        else if constexpr (waveform == TriAliased)
+        {
+            (Float4::broadcast(2.f) * Simd::max(bipolar, zero - bipolar) - one).store(y + n);
+        }
+        else if constexpr (waveform == SawAliased)
+        {
+            bipolar.store(y + n);
+        }
+        else if constexpr (waveform == SawAA)
+        {
+            // power of 2
+            (bipolar * bipolar).store(x + n + 1u);
+        }
+        else if constexpr (waveform == TriAA)
+        {
+            // add 1 offset to the negated parabola and take the sign of the ramp, the half
+            // step bias only moves 0 to the positive side as copysign would
+            const Float4 sign { Simd::min(Simd::max((bipolar + Float4::broadcast(0.5f * Phase::BipolarStep)) * Float4::broadcast(1099511627776.f), zero - one), one) };
+            (sign * (one - bipolar * bipolar)).store(x + n + 1u);
+        }
+    }
+
+    if constexpr (waveform == SawAA || waveform == TriAA)
+    {
+        // differentiator over the chunk, every sample minus the one before
+        for (unsigned int n = 0; n < vectorSamples; n += Simd::Lanes)
+        {
+            const Float4 difference { Float4::load(x + n + 1u) - Float4::load(x + n) };
+
+            // apply compensation coeff, the triangle clips above 0 to avoid the spike
+            if constexpr (waveform == SawAA)
+                (difference * coeff).store(y + n);
+            else
+                (Float4::broadcast(2.f) * (Simd::min(difference, zero) * coeff) + one).store(y + n);
+        }
+
+        differentiatorState = x[numSamples];
+    }
 
-    // apply compensation coeff and return
-    return 2.f * (output * differentiatorCoeff) + 1.f;
+    std::copy(y, y + numSamples, output);
 }
 
 }
@@ -3,9 +3,15 @@
 #include <JuceHeader.h>
 #include "Ramp.h"
 
+#include <cstdint>
+
 namespace DSP
 {
 
+// Audio rate oscillator
+// The phase is a 32 bit integer accumulator that wraps by itself, the waveform is selected
+// once per block and every kernel runs Simd::Lanes samples at a time, the Sin on the
+// FastMath approximation and the DPW differentiators over the block
 class Oscillator
 {
 public:
@@ -44,22 +50,31 @@ public:
     void renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples);
 
 private:
+    static constexpr unsigned int ChunkSize { 64 };
+
     double sampleRate { 48000.0 };
     Ramp<float> ramp;
 
     float frequency { 1.f };
     OscType type { Sin };
 
-    float phaseState { 0.f };
-    float phaseInc { 0.f };
+    // Phase and its increment per sample, a full cycle is 2^32
+    std::uint32_t phaseState { 0 };
+    std::uint32_t phaseInc { 0 };
 
     float differentiatorState { 0.f };
     float differentiatorCoeff { 0.f };
 
-    // DPW methods
+    // Recalculate the phase increment and the DPW compensation for the frequency and sample rate
+    void updateIncrement();
+
+    // Process a buffer with one waveform
+    template<OscType waveform>
+    void processBlock(float* output, unsigned int numSamples);
 
-    float dpwTri();
-    float dpwSaw();
+    // Process up to ChunkSize samples with one waveform
+    template<OscType waveform>
+    void processChunk(float* output, unsigned int numSamples);
 };
 
 }
@@ -0,0 +1,116 @@
+// Noise and speed of the DSP::Biquad topologies
+// g++ -std=c++17 -O2 -I../projects/DSP biquad_topologies.cpp ../projects/DSP/Biquad.cpp -o biquad_topologies
+
+#include "Biquad.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // RBJ low pass, rounded to the float coefficients every topology is given
+    std::array<float, 5> lowPass(double freq, double q, double sampleRate)
+    {
+        const double w0 { 2.0 * M_PI * freq / sampleRate };
+        const double alpha { std::sin(w0) / (2.0 * q) };
+        const double a0 { 1.0 + alpha };
+        const double b1 { (1.0 - std::cos(w0)) / a0 };
+        return { static_cast<float>(b1 / 2.0), static_cast<float>(b1), static_cast<float>(b1 / 2.0),
+                 static_cast<float>(-2.0 * std::cos(w0) / a0), static_cast<float>((1.0 - alpha) / a0) };
+    }
+
+    // Double precision direct form I on the same float coefficients as the reference,
+    // so the error is the arithmetic noise of a topology and not coefficient quantization
+    std::vector<double> reference(const std::array<float, 5>& c, const std::vector<float>& x)
+    {
+        std::vector<double> y(x.size());
+        double x1 { 0.0 }, x2 { 0.0 }, y1 { 0.0 }, y2 { 0.0 };
+        for (size_t n = 0; n < x.size(); ++n)
+        {
+            y[n] = c[0] * x[n] + c[1] * x1 + c[2] * x2 - c[3] * y1 - c[4] * y2;
+            x2 = x1;
+            x1 = x[n];
+            y2 = y1;
+            y1 = y[n];
+        }
+        return y;
+    }
+}
+
+int main()
+{
+    const double sampleRate { 48000.0 };
+    const unsigned int numSamples { 1 << 18 };
+    const char* names[] { "DirectFormI", "TransposedDirectFormII", "StateSpace" };
+
+    std::mt19937 rng { 1 };
+    std::uniform_real_distribution<float> dist { -0.5f, 0.5f };
+    std::vector<float> input(numSamples);
+    for (auto& x : input)
+        x = dist(rng);
+
+    // Error against the double reference, in dB below the output
+    std::cout << "noise (dB re output)" << std::endl;
+    for (const auto& [freq, q] : { std::pair { 20.0, 0.7 }, std::pair { 40.0, 10.0 }, std::pair { 1000.0, 0.7 }, std::pair { 10000.0, 4.0 } })
+    {
+        const auto c { lowPass(freq, q, sampleRate) };
+        const auto ref { reference(c, input) };
+
+        std::cout << "  " << freq << " Hz Q " << q << ":";
+        for (unsigned int t = 0; t < 3; ++t)
+        {
+            DSP::Biquad biquad { 1, 1 };
+            biquad.setTopology(static_cast<DSP::Biquad::Topology>(t));
+            biquad.setSectionCoeffs(c, 0);
+
+            std::vector<float> output(numSamples);
+            const float* in[] { input.data() };
+            float* out[] { output.data() };
+            biquad.process(out, in, 1, numSamples);
+
+            double signal { 0.0 }, error { 0.0 };
+            for (unsigned int n = 0; n < numSamples; ++n)
+            {
+                signal += ref[n] * ref[n];
+                error += (output[n] - ref[n]) * (output[n] - ref[n]);
+            }
+            std::cout << "  " << names[t] << " " << 10.0 * std::log10(error / signal);
+        }
+        std::cout << std::endl;
+    }
+
+    // Cost per sample and channel of 8 sections at common channel counts
+    std::cout << "ns per sample and channel, 8 sections" << std::endl;
+    const auto c { lowPass(1000.0, 0.7, sampleRate) };
+    for (unsigned int numChannels : { 1u, 2u, 4u, 8u })
+    {
+        std::vector<std::vector<float>> buffers(numChannels, std::vector<float>(512, 0.1f));
+        std::vector<float*> channels;
+        for (auto& b : buffers)
+            channels.push_back(b.data());
+
+        std::cout << "  " << numChannels << " ch:";
+        for (unsigned int t = 0; t < 3; ++t)
+        {
+            DSP::Biquad biquad { 8, numChannels };
+            biquad.setTopology(static_cast<DSP::Biquad::Topology>(t));
+            for (unsigned int s = 0; s < 8; ++s)
+                biquad.setSectionCoeffs(c, s);
+
+            const unsigned int numBlocks { 4000 };
+            const auto start { std::chrono::steady_clock::now() };
+            for (unsigned int b = 0; b < numBlocks; ++b)
+                biquad.process(channels.data(), channels.data(), numChannels, 512);
+            const std::chrono::duration<double, std::nano> elapsed { std::chrono::steady_clock::now() - start };
+
+            std::cout << "  " << names[t] << " " << elapsed.count() / (numBlocks * 512.0 * numChannels);
+        }
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+// Batch ParametricEqualizer::calculateCoeffs against the single band flavour
+// Compares coeffs and magnitude responses of both designs over type, frequency, Q and gain grids
+// g++ -std=c++17 -O2 -pthread -I../projects/DSP eq_batch_coeffs.cpp ../projects/DSP/ParametricEqualizer.cpp ../projects/DSP/Biquad.cpp ../projects/DSP/ParallelBiquad.cpp ../projects/DSP/Fft.cpp ../projects/DSP/PartitionedConvolver.cpp -o eq_batch_coeffs
+
+#include "ParametricEqualizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    using EQ = DSP::ParametricEqualizer;
+
+    // Exact design, the bilinear transform of the analog prototype in double
+    std::array<double, 5> exactCoeffs(const EQ::Band& band, double sampleRate)
+    {
+        if (band.type == EQ::Flat)
+            return { 1.0, 0.0, 0.0, 0.0, 0.0 };
+
+        const double K { std::tan(M_PI * band.freq / sampleRate) };
+        const double A { std::pow(10.0, band.gain / 40.0) };
+        const double sqrtA { std::sqrt(A) };
+        const double invQ { 1.0 / band.reso };
+
+        // (pb2 s^2 + pb1 s + pb0) / (pa2 s^2 + pa1 s + pa0)
+        double pb2 { 0.0 }, pb1 { 0.0 }, pb0 { 0.0 }, pa2 { 1.0 }, pa1 { invQ }, pa0 { 1.0 };
+        switch (band.type)
+        {
+            case EQ::HighPass: pb2 = 1.0; break;
+            case EQ::LowShelf: pb2 = A; pb1 = A * sqrtA * invQ; pb0 = A * A; pa2 = A; pa1 = sqrtA * invQ; break;
+            case EQ::Peak: pb2 = 1.0; pb1 = A * invQ; pb0 = 1.0; pa1 = invQ / A; break;
+            case EQ::LowPass: pb0 = 1.0; break;
+            case EQ::HighShelf: pb2 = A * A; pb1 = A * sqrtA * invQ; pb0 = A; pa1 = sqrtA * invQ; pa0 = A; break;
+            case EQ::BandPass: pb1 = A * A * invQ; break;
+            default: break;
+        }
+
+        const double K2 { K * K };
+        const double d0 { pa2 + pa1 * K + pa0 * K2 };
+        return { (pb2 + pb1 * K + pb0 * K2) / d0, 2.0 * (pb0 * K2 - pb2) / d0, (pb2 - pb1 * K + pb0 * K2) / d0,
+                 2.0 * (pa0 * K2 - pa2) / d0, (pa2 - pa1 * K + pa0 * K2) / d0 };
+    }
+
+    // Magnitude in dB of a section at a normalized frequency
+    template<typename T>
+    double magnitude(const T* c, double omega)
+    {
+        const std::complex<double> w { std::polar(1.0, -omega) };
+        const std::complex<double> num { static_cast<double>(c[0]) + w * (static_cast<double>(c[1]) + w * static_cast<double>(c[2])) };
+        const std::complex<double> den { 1.0 + w * (static_cast<double>(c[3]) + w * static_cast<double>(c[4])) };
+        return 20.0 * std::log10(std::max(std::abs(num) / std::abs(den), 1e-12));
+    }
+}
+
+int main()
+{
+    const char* names[] { "Flat", "HighPass", "LowShelf", "Peak", "LowPass", "HighShelf", "BandPass" };
+    const double sampleRates[] { 44100.0, 48000.0, 96000.0, 192000.0 };
+    const float resonances[] { 0.1f, 0.3f, 0.7071f, 1.f, 2.f, 5.f, 10.f, 20.f };
+    const float gains[] { -24.f, -12.f, -6.f, -1.f, 0.f, 1.f, 6.f, 12.f, 24.f };
+
+    // The ParametricEQ range, one frequency per third octave
+    std::vector<float> frequencies;
+    for (float f = 20.f; f <= 20000.f; f *= std::pow(2.f, 1.f / 3.f))
+        frequencies.push_back(f);
+
+    // Coeffs may differ by a few rounding steps of the largest coeff of the section
+    constexpr double MaxUlps { 16.0 };
+
+    // Responses are compared where MaxUlps of change to any coeff moves the response by
+    // less than MaxResponseDb, low and sharp bands are so sensitive to the rounding
+    // of their coeffs that any two float designs can differ by tens of dB near DC
+    constexpr double MaxResponseDb { 0.01 };
+
+    bool passed { true };
+    for (unsigned int type = EQ::Flat; type <= EQ::BandPass; ++type)
+    {
+        double worstUlps { 0.0 };
+        double worstDb { 0.0 };
+        unsigned int numPoints { 0 };
+        unsigned int numCompared { 0 };
+
+        for (double sampleRate : sampleRates)
+        {
+            // One batch per sample rate and type, over every frequency, Q and gain
+            std::vector<EQ::Band> bands;
+            for (float freq : frequencies)
+                for (float reso : resonances)
+                    for (float gain : gains)
+                        bands.push_back({ static_cast<EQ::FilterType>(type), freq, reso, gain });
+
+            std::vector<float> batch(bands.size() * DSP::Biquad::CoeffsPerSection);
+            EQ::calculateCoeffs(bands.data(), static_cast<unsigned int>(bands.size()), sampleRate, batch.data());
+
+            for (unsigned int b = 0; b < bands.size(); ++b)
+            {
+                const auto single { EQ::calculateCoeffs(bands[b], sampleRate) };
+                const float* batched { batch.data() + b * DSP::Biquad::CoeffsPerSection };
+
+                float largest { 1.f };
+                for (unsigned int c = 0; c < DSP::Biquad::CoeffsPerSection; ++c)
+                    largest = std::max(largest, std::fabs(single[c]));
+
+                const double ulp { std::nextafter(largest, 2.f * largest) - largest };
+                for (unsigned int c = 0; c < DSP::Biquad::CoeffsPerSection; ++c)
+                    worstUlps = std::max(worstUlps, std::fabs(single[c] - batched[c]) / ulp);
+
+                const auto exact { exactCoeffs(bands[b], sampleRate) };
+
+                // From 2 Hz to Nyquist, skipping the deep stop band of pass filters
+                for (double omega = 4.0 * M_PI / sampleRate; omega < M_PI; omega *= 1.1)
+                {
+                    const double exactDb { magnitude(exact.data(), omega) };
+                    if (exactDb < -60.0)
+                        continue;
+
+                    ++numPoints;
+                    double sensitivityDb { 0.0 };
+                    for (unsigned int c = 0; c < DSP::Biquad::CoeffsPerSection; ++c)
+                    {
+                        auto perturbed { exact };
+                        perturbed[c] += MaxUlps * ulp;
+                        sensitivityDb = std::max(sensitivityDb, std::fabs(magnitude(perturbed.data(), omega) - exactDb));
+                    }
+
+                    if (sensitivityDb > MaxResponseDb)
+                        continue;
+
+                    ++numCompared;
+
+                    worstDb = std::max(worstDb, std::fabs(magnitude(batched, omega) - magnitude(single.data(), omega)));
+                }
+            }
+        }
+
+        const bool typePassed { worstUlps <= MaxUlps && worstDb <= MaxResponseDb };
+        passed = passed && typePassed;
+        std::cout << names[type] << ": worst coeff difference " << worstUlps << " ulps, worst response difference "
+                  << worstDb << " dB over " << 100.0 * numCompared / std::max(numPoints, 1u) << "% of the points"
+                  << (typePassed ? "" : "  FAILED") << std::endl;
+    }
+
+    std::cout << (passed ? "passed" : "FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
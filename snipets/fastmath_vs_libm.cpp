@@ -0,0 +1,146 @@
+// Error and speed of DSP::FastMath against the standard library
+// Errors are measured against double precision and checked against the bounds documented in FastMath.h
+// g++ -std=c++17 -O2 -I../projects/DSP fastmath_vs_libm.cpp -o fastmath_vs_libm
+
+#include "FastMath.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    using DSP::Simd::Float4;
+
+    // Worst error of the float and the Float4 flavours over an evenly spaced grid
+    // Relative errors skip the zeros of the reference
+    template<typename Function>
+    bool check(const char* name, Function function, double (*reference)(double),
+               double low, double high, bool relative, double bound, unsigned int numPoints = 4000000)
+    {
+        double worst { 0.0 }, worstAt { 0.0 };
+        for (unsigned int i = 0; i < numPoints; i += DSP::Simd::Lanes)
+        {
+            alignas(16) float x[DSP::Simd::Lanes];
+            alignas(16) float y[DSP::Simd::Lanes];
+            for (unsigned int l = 0; l < DSP::Simd::Lanes; ++l)
+                x[l] = static_cast<float>(low + (high - low) * (i + l) / (numPoints - 1.0));
+
+            function(Float4::load(x)).store(y);
+
+            for (unsigned int l = 0; l < DSP::Simd::Lanes; ++l)
+            {
+                const double expected { reference(x[l]) };
+                if (relative && expected == 0.0)
+                    continue;
+
+                for (const double value : { static_cast<double>(y[l]), static_cast<double>(function(x[l])) })
+                {
+                    const double error { relative ? std::fabs(value / expected - 1.0) : std::fabs(value - expected) };
+                    if (error > worst)
+                    {
+                        worst = error;
+                        worstAt = x[l];
+                    }
+                }
+            }
+        }
+
+        const bool passed { worst <= bound };
+        std::cout << "  " << name << " [" << low << ", " << high << "] max " << (relative ? "relative" : "absolute")
+                  << " error " << worst << " at " << worstAt << ", bound " << bound << (passed ? "" : "  FAILED") << std::endl;
+        return passed;
+    }
+
+    // ns per value over a block of arguments in [-3, 3], best of a few runs
+    template<typename Block>
+    double time(Block block)
+    {
+        constexpr unsigned int BlockSize { 4096 };
+        constexpr unsigned int NumBlocks { 2000 };
+
+        alignas(16) float x[BlockSize];
+        alignas(16) float y[BlockSize];
+        for (unsigned int n = 0; n < BlockSize; ++n)
+            x[n] = -3.f + 6.f * n / BlockSize;
+
+        double best { 0.0 };
+        float sink { 0.f };
+        for (unsigned int r = 0; r < 4; ++r)
+        {
+            const auto start { std::chrono::steady_clock::now() };
+            for (unsigned int b = 0; b < NumBlocks; ++b)
+            {
+                block(x, y, BlockSize);
+                sink += y[b % BlockSize];
+            }
+            const std::chrono::duration<double, std::nano> elapsed { std::chrono::steady_clock::now() - start };
+
+            if (r == 0 || elapsed.count() < best)
+                best = elapsed.count();
+        }
+
+        // Keeps the results alive so the loops are not optimized away
+        if (sink == 1234.5f)
+            std::cout << "";
+
+        return best / (static_cast<double>(NumBlocks) * BlockSize);
+    }
+
+    template<typename Function>
+    auto scalarBlock(Function function)
+    {
+        return [function] (const float* x, float* y, unsigned int numSamples)
+        {
+            for (unsigned int n = 0; n < numSamples; ++n)
+                y[n] = function(x[n]);
+        };
+    }
+
+    template<typename Function>
+    auto vectorBlock(Function function)
+    {
+        return [function] (const float* x, float* y, unsigned int numSamples)
+        {
+            for (unsigned int n = 0; n < numSamples; n += DSP::Simd::Lanes)
+                function(Float4::load(x + n)).store(y + n);
+        };
+    }
+}
+
+int main()
+{
+    const auto fastTanh { [] (auto x) { return DSP::FastMath::tanh(x); } };
+    const auto fastExp2Fraction { [] (auto x) { return DSP::FastMath::exp2Fraction(x); } };
+    const auto fastExp { [] (auto x) { return DSP::FastMath::exp(x); } };
+    const auto fastExp2 { [] (auto x) { return DSP::FastMath::exp2(x); } };
+    const auto fastSin { [] (auto x) { return DSP::FastMath::sin(x); } };
+    const auto fastTan { [] (auto x) { return DSP::FastMath::tan(x); } };
+
+    // The bounds documented in FastMath.h
+    std::cout << "error against double precision" << std::endl;
+    bool passed { true };
+    passed = check("tanh", fastTanh, std::tanh, -12.0, 12.0, true, 3.7e-7) && passed;
+    passed = check("tanh", fastTanh, std::tanh, -1e-3, 1e-3, true, 3.7e-7) && passed;
+    passed = check("exp2Fraction", fastExp2Fraction, std::exp2, -0.5, 0.5, true, 1.8e-7) && passed;
+    passed = check("exp", fastExp, std::exp, -87.0, 87.0, true, 1.8e-7) && passed;
+    passed = check("exp2", fastExp2, std::exp2, -126.0, 126.0, true, 1.8e-7) && passed;
+    passed = check("sin", fastSin, std::sin, -2.0 * M_PI, 2.0 * M_PI, false, 1.9e-7) && passed;
+    passed = check("sin", fastSin, std::sin, -8192.0 * M_PI, 8192.0 * M_PI, false, 1.9e-7, 40000000) && passed;
+    passed = check("tan", fastTan, std::tan, -1.5707, 1.5707, true, 3.5e-7) && passed;
+
+    std::cout << "ns per value: std, FastMath float, FastMath Float4" << std::endl;
+    const auto halfTan { [] (auto x) { return DSP::FastMath::tan(x * DSP::Simd::broadcast<decltype(x)>(0.5f)); } };
+    std::cout << "  tanh " << time(scalarBlock([] (float x) { return std::tanh(x); })) << ", "
+              << time(scalarBlock(fastTanh)) << ", " << time(vectorBlock(fastTanh)) << std::endl;
+    std::cout << "  exp " << time(scalarBlock([] (float x) { return std::exp(x); })) << ", "
+              << time(scalarBlock(fastExp)) << ", " << time(vectorBlock(fastExp)) << std::endl;
+    std::cout << "  sin " << time(scalarBlock([] (float x) { return std::sin(x); })) << ", "
+              << time(scalarBlock(fastSin)) << ", " << time(vectorBlock(fastSin)) << std::endl;
+    std::cout << "  tan " << time(scalarBlock([] (float x) { return std::tan(0.5f * x); })) << ", "
+              << time(scalarBlock(halfTan)) << ", " << time(vectorBlock(halfTan)) << std::endl;
+
+    std::cout << (passed ? "passed" : "FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
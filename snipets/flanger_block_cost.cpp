@@ -0,0 +1,65 @@
+// Cost of DSP::Flanger per processed block at common host block sizes
+// g++ -std=c++17 -O2 -I../projects/DSP flanger_block_cost.cpp ../projects/DSP/Flanger.cpp ../projects/DSP/DelayLine.cpp ../projects/DSP/Lfo.cpp -o flanger_block_cost
+
+#include "Flanger.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main()
+{
+    const double sampleRate { 48000.0 };
+    const unsigned int numChannels { 2 };
+    const char* names[] { "Linear", "Hermite", "Lagrange", "Thiran" };
+
+    // One second of noise per run, cut in blocks of the host size
+    // The best of a few runs is kept, after one untimed run to warm up
+    const unsigned int numSamples { 48000 };
+    const unsigned int numRuns { 8 };
+    std::mt19937 rng { 1 };
+    std::uniform_real_distribution<float> dist { -0.5f, 0.5f };
+    std::vector<std::vector<float>> input(numChannels, std::vector<float>(numSamples));
+    std::vector<std::vector<float>> output(numChannels, std::vector<float>(numSamples));
+    for (auto& channel : input)
+        for (auto& x : channel)
+            x = dist(rng);
+
+    std::cout << "block size, then ns per block and ns per sample for every interpolation" << std::endl;
+    for (unsigned int blockSize = 32; blockSize <= 1024; blockSize *= 2)
+    {
+        std::cout << blockSize << ":";
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            DSP::Flanger flanger { 20.f, numChannels };
+            flanger.prepare(sampleRate, 20.f, numChannels);
+            flanger.setOffset(2.f);
+            flanger.setDepth(3.f);
+            flanger.setModulationRate(0.5f);
+            flanger.setInterpolation(static_cast<DSP::DelayLine::Interpolation>(i));
+
+            double best { 0.0 };
+            for (unsigned int r = 0; r <= numRuns; ++r)
+            {
+                const auto start { std::chrono::steady_clock::now() };
+                for (unsigned int n = 0; n + blockSize <= numSamples; n += blockSize)
+                {
+                    const float* in[] { input[0].data() + n, input[1].data() + n };
+                    float* out[] { output[0].data() + n, output[1].data() + n };
+                    flanger.process(out, in, numChannels, blockSize);
+                }
+                const std::chrono::duration<double, std::nano> elapsed { std::chrono::steady_clock::now() - start };
+
+                if (r == 1 || (r > 1 && elapsed.count() < best))
+                    best = elapsed.count();
+            }
+
+            const double numBlocks { static_cast<double>(numSamples / blockSize) };
+            std::cout << "  " << names[i] << " " << best / numBlocks << " / " << best / (numBlocks * blockSize);
+        }
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
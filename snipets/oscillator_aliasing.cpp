@@ -0,0 +1,166 @@
+// Aliasing and cost of the DSP::Oscillator DPW and PolyBLEP waveforms against DSP::WavetableOscillator
+// g++ -std=c++17 -O2 -pthread -I../projects/DSP oscillator_aliasing.cpp ../projects/DSP/Oscillator.cpp ../projects/DSP/WavetableOscillator.cpp ../projects/DSP/Wavetable.cpp ../projects/DSP/Fft.cpp -o oscillator_aliasing
+
+#include "Fft.h"
+#include "Oscillator.h"
+#include "WavetableOscillator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    using Generator = std::function<void(float*, unsigned int)>;
+
+    constexpr double SampleRate { 48000.0 };
+    constexpr unsigned int BlockSize { 256 };
+
+    Generator oscillator(DSP::Oscillator::OscType type, double freq)
+    {
+        auto osc { std::make_shared<DSP::Oscillator>() };
+        osc->setType(type);
+        osc->prepare(SampleRate);
+        osc->setFrequency(static_cast<float>(freq));
+        return [osc] (float* output, unsigned int numSamples) { osc->process(output, numSamples); };
+    }
+
+    Generator wavetable(DSP::Wavetable::Waveform waveform, double freq)
+    {
+        auto osc { std::make_shared<DSP::WavetableOscillator>() };
+        osc->setWaveform(waveform);
+        osc->prepare(SampleRate);
+        osc->setFrequency(static_cast<float>(freq));
+        return [osc] (float* output, unsigned int numSamples) { osc->process(output, numSamples); };
+    }
+
+    // Power of everything that is not a harmonic of freq, in dB below the fundamental
+    // Worst single alias below 10 kHz, where it is most audible, and the total over the band
+    void printAliasing(const char* name, Generator generate, double freq)
+    {
+        constexpr unsigned int FftSize { 1 << 16 };
+        constexpr unsigned int Skip { 4864 };
+        constexpr int HarmonicWidth { 7 };
+
+        // Past the start transients of the DPW differentiators
+        std::vector<float> signal(FftSize + Skip);
+        for (unsigned int n = 0; n < signal.size(); n += BlockSize)
+            generate(signal.data() + n, BlockSize);
+
+        // Blackman-Harris window, side lobes well below the aliases that are measured
+        std::vector<float> windowed(FftSize);
+        for (unsigned int n = 0; n < FftSize; ++n)
+        {
+            const double a { 2.0 * M_PI * n / FftSize };
+            windowed[n] = static_cast<float>(signal[n + Skip] * (0.35875 - 0.48829 * std::cos(a) + 0.14128 * std::cos(2.0 * a) - 0.01168 * std::cos(3.0 * a)));
+        }
+
+        DSP::Fft fft { FftSize };
+        std::vector<float> real(FftSize / 2 + 1), imag(FftSize / 2 + 1);
+        fft.forward(windowed.data(), real.data(), imag.data());
+
+        const int numBins { static_cast<int>(FftSize / 2 + 1) };
+        std::vector<bool> isHarmonic(numBins, false);
+        std::fill(isHarmonic.begin(), isHarmonic.begin() + 8, true);
+        for (unsigned int h = 1; h * freq < SampleRate / 2.0; ++h)
+        {
+            const int bin { static_cast<int>(h * freq / SampleRate * FftSize) };
+            for (int k = std::max(bin - HarmonicWidth + 1, 0); k <= std::min(bin + HarmonicWidth, numBins - 1); ++k)
+                isHarmonic[k] = true;
+        }
+
+        const int fundamentalBin { static_cast<int>(freq / SampleRate * FftSize) };
+        const int audibleBins { static_cast<int>(10000.0 / SampleRate * FftSize) };
+        double fundamental { 0.0 }, harmonics { 0.0 }, aliases { 0.0 }, worstAlias { 0.0 };
+        for (int k = 0; k < numBins; ++k)
+        {
+            const double power { static_cast<double>(real[k]) * real[k] + static_cast<double>(imag[k]) * imag[k] };
+            if (std::abs(k - fundamentalBin) < HarmonicWidth)
+                fundamental = std::max(fundamental, power);
+
+            if (isHarmonic[k])
+            {
+                harmonics += power;
+                continue;
+            }
+
+            aliases += power;
+            if (k < audibleBins)
+                worstAlias = std::max(worstAlias, power);
+        }
+
+        std::cout << "  " << name << ": worst alias below 10 kHz " << 10.0 * std::log10(worstAlias / fundamental + 1e-30)
+                  << " dB, total " << 10.0 * std::log10(aliases / harmonics + 1e-30) << " dB" << std::endl;
+    }
+
+    // ns per sample at middle C, best of a few runs
+    double time(Generator generate)
+    {
+        constexpr unsigned int NumBlocks { 20000 };
+
+        std::vector<float> block(BlockSize);
+        double best { 0.0 };
+        float sink { 0.f };
+        for (unsigned int r = 0; r < 4; ++r)
+        {
+            const auto start { std::chrono::steady_clock::now() };
+            for (unsigned int b = 0; b < NumBlocks; ++b)
+            {
+                generate(block.data(), BlockSize);
+                sink += block[b % BlockSize];
+            }
+            const std::chrono::duration<double, std::nano> elapsed { std::chrono::steady_clock::now() - start };
+
+            if (r == 0 || elapsed.count() < best)
+                best = elapsed.count();
+        }
+
+        // Keeps the output alive so the loops are not optimized away
+        if (sink == 1234.5f)
+            std::cout << "";
+
+        return best / (static_cast<double>(NumBlocks) * BlockSize);
+    }
+}
+
+int main()
+{
+    using Osc = DSP::Oscillator;
+    using Table = DSP::Wavetable;
+
+    Table::waitForShared();
+
+    // The DPW waveforms stop at 10 kHz
+    std::cout << "aliasing, in dB re the fundamental" << std::endl;
+    for (const double freq : { 1234.5, 4321.0, 9876.5, 15432.1 })
+    {
+        std::cout << freq << " Hz" << std::endl;
+        printAliasing("Saw aliased", oscillator(Osc::SawAliased, freq), freq);
+        if (freq <= 10000.0)
+            printAliasing("Saw DPW", oscillator(Osc::SawAA, freq), freq);
+        printAliasing("Saw PolyBLEP", oscillator(Osc::SawPolyBlep, freq), freq);
+        printAliasing("Saw wavetable", wavetable(Table::Saw, freq), freq);
+        printAliasing("Square PolyBLEP", oscillator(Osc::SqrPolyBlep, freq), freq);
+        printAliasing("Square wavetable", wavetable(Table::Sqr, freq), freq);
+        printAliasing("Triangle aliased", oscillator(Osc::TriAliased, freq), freq);
+        if (freq <= 10000.0)
+            printAliasing("Triangle DPW", oscillator(Osc::TriAA, freq), freq);
+        printAliasing("Triangle PolyBLAMP", oscillator(Osc::TriPolyBlamp, freq), freq);
+        printAliasing("Triangle wavetable", wavetable(Table::Tri, freq), freq);
+    }
+
+    const double middleC { 261.63 };
+    std::cout << "ns per sample at " << middleC << " Hz" << std::endl;
+    std::cout << "  Saw DPW " << time(oscillator(Osc::SawAA, middleC)) << ", PolyBLEP " << time(oscillator(Osc::SawPolyBlep, middleC))
+              << ", wavetable " << time(wavetable(Table::Saw, middleC)) << std::endl;
+    std::cout << "  Square PolyBLEP " << time(oscillator(Osc::SqrPolyBlep, middleC))
+              << ", wavetable " << time(wavetable(Table::Sqr, middleC)) << std::endl;
+    std::cout << "  Triangle DPW " << time(oscillator(Osc::TriAA, middleC)) << ", PolyBLAMP " << time(oscillator(Osc::TriPolyBlamp, middleC))
+              << ", wavetable " << time(wavetable(Table::Tri, middleC)) << std::endl;
+
+    return 0;
+}